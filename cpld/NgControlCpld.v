@@ -3,6 +3,8 @@
 * 											*
 * Requisites								*
 *	inblock.v								*
+*	outblock.v								*
+*	faults.v								*
 *	board.v									*
 *											*
 * Requisite to								*
@@ -34,6 +36,8 @@
  * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/*
+
 TO DO: **************************************
 
 Adders! (this requires removing the additions from the msp code)
@@ -43,6 +47,18 @@ NOTES: **************************************
 All the ugliness accocated with the inblock needing extra mspclk cycles
 to load has been fixed :-)
 
+The Quartus reports in this directory (*.rpt, *.summary, the .pof and .sof)
+are still those of the July 2009 build: 181 of 570 LEs, 118 registers, clk
+fmax 120MHz against the 40MHz needed.  They predate the readback (faults.v,
+outblock.v), the dither, the current limiter and the phase lock, and have to
+be regenerated before the fit and timing are taken as known.  Counted from
+the design as sim/ elaborates it, PHASES = 1 has 335 registers before Quartus
+removes the unused ones.  The 2009 design had 165, which fitted as 118 (the
+diode signal, the dead time register and the aux setpoint went); the same
+removals, and board 1's unused phase lock, leave about 275.
+The firmware is built with FPGA_LEGACY_SPI (see fpga.h) until then, so that
+it talks to the programmed image in that build's protocol.
+
 Description: ********************************
 
 This is the top level of a Verilog design for 
@@ -59,6 +75,16 @@ to the gate buffers on the power board.
 This version is designed to be run at 40MHz, controlling a tracker with a 20kHz cycle
 (2000 clock units per cycle)
 
+PHASES sets how many power boards are driven, up to the three inblock can address.
+Boards 2 and 3 run at board 1's frequency, offset by their phase registers (see board.v),
+so that interleaved boards share the input and output ripple.  They share the fault
+inputs and FSReset with board 1, and the current limit comparator, which sees the total
+input current.  Any of them shut down by the limiter shuts all of them down, as the
+others would otherwise be left carrying the whole current.  An unused board's outputs
+are held off (SD high).
+aux2..SD3 have no pin assignments yet, there are none on the single board controller.
+Each board takes about a third of the EPM570, so three need a larger device.
+
 */
 
 module NgControlCpld (
@@ -87,17 +113,23 @@ module NgControlCpld (
 	nVoltFault,				// 150V overvoltage signal. Comes from a comparator.  
 	nReg15Fault,			// 15V voltage fault. Comes from a comparator. 
 	nReg5Fault,				// 5V voltage fault. Comes from the switching regulator. 
-	nCurrentFault,			// Input under-current protection. Comes from a comparator. 
+	nCurrentFault,			// Input current limit. Comes from a comparator. Cuts the main pulse short each cycle it trips (board.v) 
 	
 	aux, main, diode,		// to the FETs
-	SD 						// output of shutdown signal to the power board
+	SD, 					// output of shutdown signal to the power board
+	aux2, main2, diode2, SD2,	// the same for the second and third boards, if PHASES says they are there
+	aux3, main3, diode3, SD3
 	);
 
+	parameter PHASES = 1;		// power boards driven, 1 to 3
+
 	//-------------------------------------------------------------------
 	output serialout;			
 	output LED1, LED2; 	
 	output nSD;
 	output aux, main, diode, SD;
+	output aux2, main2, diode2, SD2;
+	output aux3, main3, diode3, SD3;
 
 	//-------------------------------------------------------------------	
 	input clk;
@@ -113,24 +145,67 @@ module NgControlCpld (
 	//-------------------------------------------------------------------			
 	wire [15:0] data; 					// data from inblock. see notes in inblock
 	wire countglobal;				 	// sets the value of all counter reset points to the current data, included for reverse compatability
+	wire commit;						// end of an SPI frame, apply the new register values
+	wire [10:0] main_length, period;	// applied values, for the readback
+	wire [15:0] cycles;					// switching cycles, for the readback
+	wire [5:0] fault_cause, fault_live;	// which fault tripped us, for the readback
+	wire limiting, limited;				// the current limiter, for the readback
+	wire limiting1, limited1, limiting2, limited2, limiting3, limited3;
+	wire nlimited1, nlimited2, nlimited3;
+	wire [10:0] counter1;				// board 1's counter, which the others follow
 	//board specific:
-	wire load, nSDcomp;					// signal for a board to load data specific to itself; a hack to see why a fault was generated, sent to an LED.  when we are done debugging, do we need this at all (to the MSP?) will we do anything differently based on where the fault came from?
+	wire load, load2, load3, nSDcomp;					// signal for a board to load data specific to itself; a hack to see why a fault was generated, sent to an LED.  when we are done debugging, do we need this at all (to the MSP?) will we do anything differently based on where the fault came from?
 	wire enable;
 	wire nFS; /* Fault signal */ 
 
 	/* Security logic - note, no latching here*/ 
 	and(enable,  nMSPReset, nVoltFault, nReg15Fault, nReg5Fault, nFPGAReset );
-	buf(nFS, enable);
+	
+	// Every board shuts down if the limiter shuts any of them down
+	not(nlimited1, limited1);
+	not(nlimited2, limited2);
+	not(nlimited3, limited3);
+	and(nFS, enable, nlimited1, nlimited2, nlimited3);
+	or(limited, limited1, limited2, limited3);
+	or(limiting, limiting1, limiting2, limiting3);
 	
 	//the input block FIXME: my want to modify the protocol.  
-	inblock inblock(.data(data[15:0]), .countglobal(countglobal), .load1(load), .clk(clk), 
-					.mspclk(mspclk), .serialin(serialin), .nchpsel(nchpsel));
+	inblock inblock(.data(data[15:0]), .countglobal(countglobal), .load1(load), .load2(load2), .load3(load3), .clk(clk), 
+					.mspclk(mspclk), .serialin(serialin), .nchpsel(nchpsel), .commit(commit));
 
 	// the control for the board
 	board board(.aux(aux), .main(main), .diode(diode), .clk(clk), .SD(SD),
 				.data(data[13:0]), 
-				.load(load), .nFS(nFS),
-				.FS_Reset(FSReset),  .countglobal(countglobal));
+				.load(load), .nFS(nFS), .nlimit(nCurrentFault), .limiting(limiting1), .limited(limited1),
+				.FS_Reset(FSReset),  .countglobal(countglobal), .commit(commit),
+				.main_length(main_length[10:0]), .period(period[10:0]), .cycles(cycles[15:0]),
+				.counter(counter1[10:0]), .phase_ref(11'b0), .slave(1'b0));
+
+	// the interleaved boards, if there are any
+	generate
+		if (PHASES >= 2) begin : PHASE2
+			board board2(.aux(aux2), .main(main2), .diode(diode2), .clk(clk), .SD(SD2),
+						.data(data[13:0]), 
+						.load(load2), .nFS(nFS), .nlimit(nCurrentFault), .limiting(limiting2), .limited(limited2),
+						.FS_Reset(FSReset),  .countglobal(countglobal), .commit(commit),
+						.main_length(), .period(), .cycles(),
+						.counter(), .phase_ref(counter1[10:0]), .slave(1'b1));
+		end else begin : NOPHASE2
+			buf(aux2, 1'b0); buf(main2, 1'b0); buf(diode2, 1'b0); buf(SD2, 1'b1);
+			buf(limiting2, 1'b0); buf(limited2, 1'b0);
+		end
+		if (PHASES >= 3) begin : PHASE3
+			board board3(.aux(aux3), .main(main3), .diode(diode3), .clk(clk), .SD(SD3),
+						.data(data[13:0]), 
+						.load(load3), .nFS(nFS), .nlimit(nCurrentFault), .limiting(limiting3), .limited(limited3),
+						.FS_Reset(FSReset),  .countglobal(countglobal), .commit(commit),
+						.main_length(), .period(), .cycles(),
+						.counter(), .phase_ref(counter1[10:0]), .slave(1'b1));
+		end else begin : NOPHASE3
+			buf(aux3, 1'b0); buf(main3, 1'b0); buf(diode3, 1'b0); buf(SD3, 1'b1);
+			buf(limiting3, 1'b0); buf(limited3, 1'b0);
+		end
+	endgenerate
 	//			,
 	//			.led1(LED1), .led2(LED2)); 
 	//FIXME:count_load should be eliminated when inblock is redone. Fixed, but left countglobal for reverse compatability
@@ -140,12 +215,17 @@ module NgControlCpld (
 	not(nSD, SD);
 
 	//debugging logic, often using LED1 and LED2:
-	DFFE (.D(1'b1), .CLK(FSReset), .CLRN(nFPGAReset), .PRN(1'b1), .Q(LED1)); //structure used before
+	DFFE LED1LATCH (.D(1'b1), .CLK(FSReset), .CLRN(nFPGAReset), .PRN(1'b1), .Q(LED1)); //structure used before
 //	DFFE (.D(1'b1), .CLK(FSReset), .CLRN(nReg15Fault), .PRN(1'b1), .Q(LED2)); //structure used before
 
 	// Let the user know if there was a hard fault. 
 	and(LED2, nVoltFault, nReg15Fault, nReg5Fault);
 		
-	// Setting presently un-used outputs to 0. 
-	buf (serialout, 1'b0); 
+	// Readback to the MSP430, see outblock.v for the layout
+	faults faults(.cause(fault_cause[5:0]), .live(fault_live[5:0]), .clk(clk), .FSReset(FSReset),
+				.nVoltFault(nVoltFault), .nReg15Fault(nReg15Fault), .nReg5Fault(nReg5Fault), 
+				.nCurrentFault(nCurrentFault), .nMSPReset(nMSPReset), .nFPGAReset(nFPGAReset));
+	outblock outblock(.serialout(serialout), .clk(clk), .mspclk(mspclk), .nchpsel(nchpsel),
+				.status({1'b0, limited, fault_cause[5:0], SD, limiting, fault_live[5:0], 
+						 5'b0, main_length[10:0], 5'b0, period[10:0], cycles[15:0]}));
 endmodule
\ No newline at end of file
@@ -4,8 +4,11 @@
 * 											*
 * Requisites								*
 *	edecode4.v								*
+*	gte11.v									*
 *	signal.v								*
 *	counter.v								*
+*	count16.v								*
+*	dither.v								*
 *											*
 * Requisite to:								*
 *	mining2fpga.v							*
@@ -20,6 +23,23 @@ This is the control logic for an individual power board.
 It instantiates 3 signal modules, and decodes the top 2 bits of the data
 bus to decide which signal the data is for.  
 
+The registers load as each word of an SPI frame arrives, but the signal modules only
+take up the new on/off points when the frame ends (commit from inblock).
+
+The main pulse can be stretched by one clk in some cycles to dither its length
+below one count (see dither.v).
+
+nlimit is a cycle by cycle current limit: when it goes low the main pulse is
+cut short for the rest of the cycle.  If that happens in 4 cycles in a row the
+board is shut down, as for a fault, until FS_Reset.  One noisy edge from the
+comparator then only costs a short pulse rather than a restart of tracking.
+
+With several boards interleaved, phase_ref is the counter of board 1.  A board
+with slave high and a nonzero phase register restarts its counter each time
+phase_ref reaches the phase, rather than at its own period, so that it runs at
+board 1's frequency, phase + 2 clk behind it.  The phase must be less than
+board 1's period.  Board 1 itself is never a slave.
+
 It also shuts the power board down if there is a fault, if the MSP stops sending the enable signal,
 or if the PLL is not locked.  The diode signal is also disabled if the main signal is on
 */
@@ -49,7 +69,17 @@ module board (
 	data[13:0],			// the input data, including signal address
 	load,				// enable the board to send data through.  Comes from the decoding of the board addres (data[14:13]) in inblock
 	nFS,				// Fault signal
+	nlimit,				// Current limit comparator, cut the main pulse short (active low)
+	limiting,			// the main pulse was cut short this cycle
+	limited,			// shut down by the current limiter, until FS_Reset
 	FS_Reset,			// Reset the fault signal latch
+	main_length,		// the applied main pulse length and period, for the readback
+	period,
+	cycles,				// switching cycles, wraps
+	counter,			// the counter, for the phase_ref of other boards
+	phase_ref,			// board 1's counter
+	slave,				// follow phase_ref if the phase register is set
+	commit,				// end of an SPI frame: apply the registers loaded during it to the signals
 	countglobal//,			//signal to load the reset value for the Counter FIXME: the counter should be integrated with the rest of the board signal; do this along with the overhaul of inblock. Fix: Now does both; can reset clocks locally or globally
 //	led1, led2
 	);
@@ -58,6 +88,12 @@ module board (
 	output main;
 	output diode;
 	output SD;
+	output [10:0] main_length;
+	output [10:0] period;
+	output [15:0] cycles;
+	output [10:0] counter;
+	output limiting;
+	output limited;
 //	output led1; 
 //	output led2;
 	
@@ -66,14 +102,18 @@ module board (
 	input load;
 	input FS_Reset;
 	input nFS;
+	input nlimit;
 	input countglobal; 
+	input commit;
+	input [10:0] phase_ref;
+	input slave;
 	
 	wire [10:0] counter;
 	wire [10:0] period;
-	wire [10:0] aux_length, aux_overlap, main_length, dead_time; 
+	wire [10:0] aux_length, aux_overlap, main_length, dead_time, phase; 
 	wire [10:0] aux_on, aux_off, main_on, main_off, diode_on, diode_off; 
 		
-	wire load_al, load_ao, load_ml, load_dt; // Register load signals
+	wire load_al, load_ao, load_ml, load_dt, load_fr, load_ph; // Register load signals
 	
 	wire nmain;			//inversion of main for diode protection
 	wire enable; 
@@ -81,13 +121,26 @@ module board (
 	wire nenable;		//inversion of enable signal, to reset the counter when there is an error
 	wire countlocal;	// signal to change counter reset value through the BB00X command (only effects this board, preferable)
 	wire countload;		// signal to change counter reset value through the 00XXX command (this will apply to every board controled by the device, for reverse compatability)
-	wire signal_load; 	// Load signal for the three signal modules to load the set/reset registers
+	wire signal_load; 	// Load signal for the three signal modules to load the set/reset registers, once per frame
 
 	wire latch_reset;   // Generated signal for reset-ing the latch. 
+	wire restart, restart_d, nrestart_d, cycle;	// the counter restarting, and its rising edge
+	wire main_gate, main_d, main_tail;	// main before the dither, delayed a clk, and the stretch
+	wire stretch;		// stretch the main pulse this cycle
+
+	wire limit_s, nlimit_d, limit;	// nlimit synchronised and inverted
+	wire main_pulse, cut, cut_d, held, ncycle, cut_next;	// main before the limiter; the pulse is cut short this cycle
+	wire ncut;
+	wire [3:0] limit_hist;		// which of the last 4 cycles were cut short
+	wire limit_4, nlimited;		// 4 in a row
+	wire nFS_board;				// nFS, or the limiter
+	wire nFS_Reset;
+	wire at_phase, at_phase_d, at_phase_dd, nat_phase_dd;	// phase_ref has reached the phase
+	wire phase_set, follow, sync;	// restart the counter on sync, rather than at the period
 
 	// Generate the load signals for the registers
 	edecode5 DECODE (.data(data[13:11]), .enable(load), .eq0(countlocal), 
-					 .eq1(load_al), .eq2(load_ao), .eq3(load_ml), .eq4(load_dt));
+					 .eq1(load_al), .eq2(load_ao), .eq3(load_ml), .eq4(load_fr), .eq5(load_dt), .eq6(load_ph));
 
 	or(countload, countlocal, countglobal);		// There are two ways of setting the counter period
 
@@ -97,11 +150,13 @@ module board (
 	reg11 	aux_overlap_reg (.CLK(clk), .ENA(load_ao), .D(data[10:0]), .Q(aux_overlap[10:0])); // Main/Auxilliary overlap
 	reg11 	main_length_reg (.CLK(clk), .ENA(load_ml), .D(data[10:0]), .Q(main_length[10:0])); // Main pulse length
 	reg11 	dead_time_reg (.CLK(clk), .ENA(load_dt), .D(data[10:0]), .Q(dead_time[10:0])); // Dead time around diode	
+	reg11 	phase_reg (.CLK(clk), .ENA(load_ph), .D(data[10:0]), .Q(phase[10:0])); // Offset behind board 1
 
 	//security logic
-	and(latch_reset, nFS, FS_Reset);
+	and(nFS_board, nFS, nlimited);
+	and(latch_reset, nFS_board, FS_Reset);
 
-	DFFE (.D(1'b1), .CLK(latch_reset), .CLRN(nFS), .PRN(1'b1), .Q(enable)); //structure used before
+	DFFE ENLATCH (.D(1'b1), .CLK(latch_reset), .CLRN(nFS_board), .PRN(1'b1), .Q(enable)); //structure used before
 	not (nenable, enable); //to reset the counter
 	not (SD, enable);	
 	
@@ -109,30 +164,89 @@ module board (
 //	and(denable, enable, nmain); //only allow the diode to be on when main is not
 	buf(denable, 1'b0); // Disable the diode for testing. 
 
+	//Phase lock to board 1: sync on the rising edge of phase_ref >= phase. A phase of 0 leaves the
+	//board running on its own period
+	gte11 	PHASECMP (.dataa(phase_ref[10:0]), .datab(phase[10:0]), .ageb(at_phase));
+	DFF DPHASE1 (.D(at_phase), .CLK(clk), .Q(at_phase_d));
+	DFF DPHASE2 (.D(at_phase_d), .CLK(clk), .Q(at_phase_dd));
+	not (nat_phase_dd, at_phase_dd);
+	and (sync, at_phase_d, nat_phase_dd);
+	or (phase_set, phase[0], phase[1], phase[2], phase[3], phase[4], phase[5], 
+					phase[6], phase[7], phase[8], phase[9], phase[10]);
+	and (follow, slave, phase_set);
+
 	//the counter
-	counter count(.clk(clk), .counter(counter[10:0]), .period(period[10:0]), .reset(nenable), .enable(enable)); //change reset to any off->on transistion (this coveres nSD, include re enabled by MSP
+	counter count(.clk(clk), .counter(counter[10:0]), .period(period[10:0]), .reset(nenable), .enable(enable), 
+					.sync(sync), .follow(follow), .restart(restart)); //change reset to any off->on transistion (this coveres nSD, include re enabled by MSP
+
+	//count the switching cycles for the readback
+	DFF DRESTART (.D(restart), .CLK(clk), .Q(restart_d));
+	not (nrestart_d, restart_d);
+	and (cycle, restart, nrestart_d);
+	count16 cycle_count (.clock(clk), .cnt_en(cycle), .q(cycles[15:0]));
 
 	// Calculate the on/off times for the signals. 
 //	buf(aux_on[10:0], 11'b0);															// aux_on = 0
 //	buf(aux_off[10:0], aux_length[10:0]);												// aux_off = aux_length
 
-	sub11(.result(main_on[10:0]), .dataa(aux_length[10:0]), .datab(aux_overlap[10:0])); // main_on = aux_length - aux_overlap
-	add11(.result(main_off[10:0]), .dataa(main_on[10:0]), .datab(main_length[10:0])); 			// main_off = main_on + main_length
+	sub11 MAINON (.result(main_on[10:0]), .dataa(aux_length[10:0]), .datab(aux_overlap[10:0])); // main_on = aux_length - aux_overlap
+	add11 MAINOFF (.result(main_off[10:0]), .dataa(main_on[10:0]), .datab(main_length[10:0])); 			// main_off = main_on + main_length
 	
-	add11(.result(diode_on[10:0]), .dataa(main_off[10:0]), .datab(dead_time[10:0]));	// diode_on = main_off + dead_time
-	sub11(.result(diode_off[10:0]), .dataa(period[10:0]), .datab(dead_time[10:0])); 	// diode_off = period - dead_time
+	add11 DIODEON (.result(diode_on[10:0]), .dataa(main_off[10:0]), .datab(dead_time[10:0]));	// diode_on = main_off + dead_time
+	sub11 DIODEOFF (.result(diode_off[10:0]), .dataa(period[10:0]), .datab(dead_time[10:0])); 	// diode_off = period - dead_time
 
-	//Generate the signal load signal by delaying the other load
-	DFFE(.D(load), .CLK(clk), .CLRN(1'b1), .PRN(1'b1), .Q(signal_load));
+	//Generate the signal load signal from the end of the frame, so that a burst writing several
+	//registers (e.g. main length and aux overlap) never applies a mix of old and new values
+	DFFE DLOAD (.D(commit), .CLK(clk), .CLRN(1'b1), .PRN(1'b1), .Q(signal_load));
 
 	//The Individual Signals
 //	signal AUXSIG (.Gate(aux), .clk(clk), .setpoint(aux_on[10:0]), .resetpoint(aux_off[10:0]), 
 //					.enable(enable), .load(signal_load), .counter(counter[10:0]));
 	signal AUXSIG (.Gate(aux), .clk(clk), .setpoint(11'b0), .resetpoint(aux_length[10:0]), 
 					.enable(enable), .load(signal_load), .counter(counter[10:0]));
-	signal MAINSIG (.Gate(main), .clk(clk), .setpoint(main_on[10:0]), .resetpoint(main_off[10:0]),
+	signal MAINSIG (.Gate(main_gate), .clk(clk), .setpoint(main_on[10:0]), .resetpoint(main_off[10:0]),
 					.enable(enable), .load(signal_load), .counter(counter[10:0]));
 	signal DIODESIG (.Gate(diode), .clk(clk), .setpoint(diode_on[10:0]), .resetpoint(diode_off[10:0]),
 					.enable(denable), .load(signal_load), .counter(counter[10:0]));
 
+	//Dither the main pulse: hold it on for one more clk after it ends, in the cycles dither picks.
+	//This takes the clk out of the dead time before the diode, which is off for now anyway
+	dither DITHER (.stretch(stretch), .clk(clk), .data(data[3:0]), .load(load_fr), 
+					.apply(signal_load), .cycle(cycle));
+	DFF DMAIN (.D(main_gate), .CLK(clk), .Q(main_d));
+	and (main_tail, main_d, stretch, enable);
+	or (main_pulse, main_gate, main_tail);
+
+	//Cycle by cycle current limit. Two flip-flops to synchronise the comparator, which adds
+	//50ns at 40MHz before the pulse is cut
+	DFF DLIM1 (.D(nlimit), .CLK(clk), .Q(limit_s));
+	DFF DLIM2 (.D(limit_s), .CLK(clk), .Q(nlimit_d));
+	not (limit, nlimit_d);
+
+	//cut = (cut | (limit & main_pulse)) & !cycle & enable: once cut, main stays off until the next
+	//cycle. Cleared while shut down, as the counter doesn't restart (and no cycle comes) until
+	//the first pulse after FS_Reset is already under way
+	and (held, limit, main_pulse);
+	not (ncycle, cycle);
+	or (cut_next, cut, held);
+	and (cut_d, cut_next, ncycle, enable);
+	DFF DCUT (.D(cut_d), .CLK(clk), .Q(cut));
+	not (ncut, cut);
+	and (main, main_pulse, ncut);
+	buf (limiting, cut);
+
+	//At the start of each cycle, remember whether the last one was cut short. These clear while
+	//FS_Reset is high, so the shutdown below is released by the same FS_Reset pulse as a fault
+	not (nFS_Reset, FS_Reset);
+	DFFE DHIST0 (.D(cut), .CLK(clk), .ENA(cycle), .CLRN(nFS_Reset), .PRN(1'b1), .Q(limit_hist[0]));
+	DFFE DHIST1 (.D(limit_hist[0]), .CLK(clk), .ENA(cycle), .CLRN(nFS_Reset), .PRN(1'b1), .Q(limit_hist[1]));
+	DFFE DHIST2 (.D(limit_hist[1]), .CLK(clk), .ENA(cycle), .CLRN(nFS_Reset), .PRN(1'b1), .Q(limit_hist[2]));
+	DFFE DHIST3 (.D(limit_hist[2]), .CLK(clk), .ENA(cycle), .CLRN(nFS_Reset), .PRN(1'b1), .Q(limit_hist[3]));
+	and (limit_4, limit_hist[0], limit_hist[1], limit_hist[2], limit_hist[3]);
+
+	//Registered, as it clears the enable latch asynchronously. Once shut down the counter stops,
+	//so this holds until FS_Reset
+	DFFE DLIMITED (.D(limit_4), .CLK(clk), .CLRN(nFS_Reset), .PRN(1'b1), .Q(limited));
+	not (nlimited, limited);
+
 endmodule
\ No newline at end of file
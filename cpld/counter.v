@@ -5,6 +5,7 @@
 *	count11.v								*
 *	reg11.v									*
 *	gt11.v									*
+*	mux1.v									*
 * Requisite to								*
 *	board.v									*
 *											*
@@ -15,6 +16,9 @@
 * a_gotterba <at> yahoo.com		 			*
 *********************************************
 This is all the  stuff related to the resetable counter
+
+With follow high the counter ignores its own period and restarts on sync
+instead, which lets another board's counter set the phase of this one (see board.v)
 */
 
 /* Copyright (C) Andreas Gotterba, 2009 */ 
@@ -41,18 +45,24 @@ module counter (
 	counter[10:0], 
 	period[10:0],
 	reset,
-	enable
+	enable,
+	sync,
+	follow,
+	restart
 	);
 	input clk;
 	input [10:0] period;	//counter's reset point
 	input reset;			//exteral reset signal
 	input enable;			//external enable signal
+	input sync;				//restart now, if following (one clk pulse)
+	input follow;			//restart on sync rather than at the period
 	
 	output [10:0] counter;	
+	output restart;			//the counter is restarting (high for a couple of cycles each period)
 		
 	wire gt;				//dirty signal that the restart condition is met
-	wire restart;			//signal to restart counter
 	wire clear;				//signal to clear the counter
+	wire wrap;				//the counter has reached its own period
 
 	//the ring counter
 	count11	count11	(.clock(clk), .q(counter[10:0]), .sclr(clear), .cnt_en(enable)); 
@@ -63,7 +73,10 @@ module counter (
 	gte11  	detect (.dataa(counter[10:0]), .datab(period[10:0]), .ageb(gt));
 	
 	//strict low pass filter on the reset signal, to prevent any glitches
-	slpf 	cleaner	(.clk(clk), .in(gt), .out(restart));
+	slpf 	cleaner	(.clk(clk), .in(gt), .out(wrap));
+
+	//pick the restart source
+	mux1	SYNCSEL	(.data0(wrap), .data1(sync), .sel(follow), .result(restart));
 	
 	//clears the counter when it meets the reset condition, or when it gets an exteral reset signal
 	or(clear, reset, restart);
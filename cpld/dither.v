@@ -0,0 +1,85 @@
+/********************************************
+* dither.v   								*
+* 											*
+* Requisites								*
+*	add4.v									*
+*											*
+* Requisite to								*
+*	board.v									*
+*											*
+*********************************************
+Gives the main pulse 4 bits of resolution below one clk period.  The MSP writes
+the fraction (sixteenths of a count) to signal 4 of the board, next to
+main_length so that both go in one two word frame; every switching
+cycle it is added into a 4 bit accumulator, and in the cycles where that carries
+board.v stretches the main pulse by one clk.  Over 16 cycles the pulse is then
+main_length + frac/16 counts long on average, spread as evenly as a first order
+sigma-delta can.  At 30kHz switching that is 16 cycles in about half a millisecond,
+well inside one period of the MSP's 1160Hz control loop.
+
+Like the other registers the fraction is loaded as its word arrives but only
+applied at the end of the frame, so it changes together with main_length.
+*/
+
+/* Copyright (C) agent, 2026 */ 
+
+/* 
+ * This file is part of the UNSWMPPTNG firmware.
+ * 
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ 
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ 
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+module dither (
+	stretch,			// stretch the main pulse by one clk this cycle
+	clk,				// the fast clock
+	data[3:0],			// the fraction, from the data bus
+	load,				// load the fraction from the data bus
+	apply,				// end of the SPI frame: use the loaded fraction
+	cycle				// a switching cycle is starting
+	);
+
+	output stretch;
+
+	input clk;
+	input [3:0] data;
+	input load;
+	input apply;
+	input cycle;
+
+	wire [3:0] loaded;	// fraction as loaded over SPI
+	wire [3:0] frac;	// fraction in use
+	wire [3:0] acc;		// the accumulator
+	wire [3:0] sum;		// acc + frac
+	wire carry;
+
+	DFFE DL0 (.D(data[0]), .CLK(clk), .ENA(load), .CLRN(1'b1), .PRN(1'b1), .Q(loaded[0]));
+	DFFE DL1 (.D(data[1]), .CLK(clk), .ENA(load), .CLRN(1'b1), .PRN(1'b1), .Q(loaded[1]));
+	DFFE DL2 (.D(data[2]), .CLK(clk), .ENA(load), .CLRN(1'b1), .PRN(1'b1), .Q(loaded[2]));
+	DFFE DL3 (.D(data[3]), .CLK(clk), .ENA(load), .CLRN(1'b1), .PRN(1'b1), .Q(loaded[3]));
+
+	DFFE DF0 (.D(loaded[0]), .CLK(clk), .ENA(apply), .CLRN(1'b1), .PRN(1'b1), .Q(frac[0]));
+	DFFE DF1 (.D(loaded[1]), .CLK(clk), .ENA(apply), .CLRN(1'b1), .PRN(1'b1), .Q(frac[1]));
+	DFFE DF2 (.D(loaded[2]), .CLK(clk), .ENA(apply), .CLRN(1'b1), .PRN(1'b1), .Q(frac[2]));
+	DFFE DF3 (.D(loaded[3]), .CLK(clk), .ENA(apply), .CLRN(1'b1), .PRN(1'b1), .Q(frac[3]));
+
+	//acc = acc + frac once per cycle; the carry out is the stretch for the cycle
+	add4 ADD (.dataa(acc[3:0]), .datab(frac[3:0]), .cout(carry), .result(sum[3:0]));
+
+	DFFE DA0 (.D(sum[0]), .CLK(clk), .ENA(cycle), .CLRN(1'b1), .PRN(1'b1), .Q(acc[0]));
+	DFFE DA1 (.D(sum[1]), .CLK(clk), .ENA(cycle), .CLRN(1'b1), .PRN(1'b1), .Q(acc[1]));
+	DFFE DA2 (.D(sum[2]), .CLK(clk), .ENA(cycle), .CLRN(1'b1), .PRN(1'b1), .Q(acc[2]));
+	DFFE DA3 (.D(sum[3]), .CLK(clk), .ENA(cycle), .CLRN(1'b1), .PRN(1'b1), .Q(acc[3]));
+	DFFE DS (.D(carry), .CLK(clk), .ENA(cycle), .CLRN(1'b1), .PRN(1'b1), .Q(stretch));
+
+endmodule
@@ -35,7 +35,9 @@ module edecode5 (
 	eq1,
 	eq2,
 	eq3,
-	eq4);
+	eq4,
+	eq5,
+	eq6);
 
 	input	[2:0]  data;
 	input	  enable;
@@ -44,6 +46,8 @@ module edecode5 (
 	output	  eq2;
 	output	  eq3;
 	output	  eq4;
+	output	  eq5;
+	output	  eq6;
 
 endmodule
 
@@ -58,8 +62,8 @@ endmodule
 // Retrieval info: PRIVATE: eq2 NUMERIC "1"
 // Retrieval info: PRIVATE: eq3 NUMERIC "1"
 // Retrieval info: PRIVATE: eq4 NUMERIC "1"
-// Retrieval info: PRIVATE: eq5 NUMERIC "0"
-// Retrieval info: PRIVATE: eq6 NUMERIC "0"
+// Retrieval info: PRIVATE: eq5 NUMERIC "1"
+// Retrieval info: PRIVATE: eq6 NUMERIC "1"
 // Retrieval info: PRIVATE: eq7 NUMERIC "0"
 // Retrieval info: PRIVATE: Latency NUMERIC "0"
 // Retrieval info: PRIVATE: aclr NUMERIC "0"
@@ -75,6 +79,8 @@ endmodule
 // Retrieval info: USED_PORT: eq2 0 0 0 0 OUTPUT NODEFVAL eq2
 // Retrieval info: USED_PORT: eq3 0 0 0 0 OUTPUT NODEFVAL eq3
 // Retrieval info: USED_PORT: eq4 0 0 0 0 OUTPUT NODEFVAL eq4
+// Retrieval info: USED_PORT: eq5 0 0 0 0 OUTPUT NODEFVAL eq5
+// Retrieval info: USED_PORT: eq6 0 0 0 0 OUTPUT NODEFVAL eq6
 // Retrieval info: USED_PORT: @eq 0 0 LPM_DECODES 0 OUTPUT NODEFVAL @eq[LPM_DECODES-1..0]
 // Retrieval info: CONNECT: @data 0 0 3 0 data 0 0 3 0
 // Retrieval info: CONNECT: @enable 0 0 0 0 enable 0 0 0 0
@@ -83,6 +89,8 @@ endmodule
 // Retrieval info: CONNECT: eq2 0 0 0 0 @eq 0 0 1 2
 // Retrieval info: CONNECT: eq3 0 0 0 0 @eq 0 0 1 3
 // Retrieval info: CONNECT: eq4 0 0 0 0 @eq 0 0 1 4
+// Retrieval info: CONNECT: eq5 0 0 0 0 @eq 0 0 1 5
+// Retrieval info: CONNECT: eq6 0 0 0 0 @eq 0 0 1 6
 // Retrieval info: LIBRARY: lpm lpm.lpm_components.all
 // Retrieval info: GEN_FILE: TYPE_NORMAL edecode5.v TRUE
 // Retrieval info: GEN_FILE: TYPE_NORMAL edecode5.inc TRUE
@@ -0,0 +1,99 @@
+/********************************************
+* faults.v   								*
+* 											*
+* Requisites								*
+*	<none>									*
+*											*
+* Requisite to								*
+*	NgControlCpld.v							*
+*											*
+*********************************************
+Remembers which of the fault inputs caused a shutdown, for the MSP to read
+back through outblock.  The (active low) fault inputs are synchronised into
+clk; cause[x] sets when fault x is seen and stays set until the MSP pulses
+FSReset, the same signal that clears the shutdown latch in board.v.
+live[x] is just the synchronised input.  nCurrentFault no longer shuts
+anything down by itself (board.v limits pulses with it), so its cause bit
+only says that the limiter has acted since the last FSReset.
+
+Bits:	0 nVoltFault, 1 nReg15Fault, 2 nReg5Fault, 3 nCurrentFault,
+		4 nMSPReset, 5 nFPGAReset
+*/
+
+/* Copyright (C) agent, 2026 */ 
+
+/* 
+ * This file is part of the UNSWMPPTNG firmware.
+ * 
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ 
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ 
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+module faults (
+	cause[5:0],			// latched: faults seen since the last FSReset (active high)
+	live[5:0],			// faults active now (active high)
+	clk,				// the fast clock
+	FSReset,			// clear the latched causes
+	nVoltFault, nReg15Fault, nReg5Fault, nCurrentFault, nMSPReset, nFPGAReset
+	);
+
+	output [5:0] cause;
+	output [5:0] live;
+
+	input clk;
+	input FSReset;
+	input nVoltFault, nReg15Fault, nReg5Fault, nCurrentFault, nMSPReset, nFPGAReset;
+
+	wire [5:0] fault;	// inverted inputs
+	wire [5:0] set;		// cause or live
+	wire [5:0] next;	// next value of cause
+	wire reset, nreset;	// FSReset, synchronised
+
+	not (fault[0], nVoltFault);
+	not (fault[1], nReg15Fault);
+	not (fault[2], nReg5Fault);
+	not (fault[3], nCurrentFault);
+	not (fault[4], nMSPReset);
+	not (fault[5], nFPGAReset);
+
+	DFF DRST (.D(FSReset), .CLK(clk), .Q(reset));
+	not (nreset, reset);
+
+	//one flip-flop is enough: a metastable live bit only delays the cause by a cycle
+	DFF DLIVE0 (.D(fault[0]), .CLK(clk), .Q(live[0]));
+	DFF DLIVE1 (.D(fault[1]), .CLK(clk), .Q(live[1]));
+	DFF DLIVE2 (.D(fault[2]), .CLK(clk), .Q(live[2]));
+	DFF DLIVE3 (.D(fault[3]), .CLK(clk), .Q(live[3]));
+	DFF DLIVE4 (.D(fault[4]), .CLK(clk), .Q(live[4]));
+	DFF DLIVE5 (.D(fault[5]), .CLK(clk), .Q(live[5]));
+
+	//cause = (cause | live) & !reset
+	or (set[0], cause[0], live[0]);
+	or (set[1], cause[1], live[1]);
+	or (set[2], cause[2], live[2]);
+	or (set[3], cause[3], live[3]);
+	or (set[4], cause[4], live[4]);
+	or (set[5], cause[5], live[5]);
+	and (next[0], set[0], nreset);
+	and (next[1], set[1], nreset);
+	and (next[2], set[2], nreset);
+	and (next[3], set[3], nreset);
+	and (next[4], set[4], nreset);
+	and (next[5], set[5], nreset);
+	DFF DCAUSE0 (.D(next[0]), .CLK(clk), .Q(cause[0]));
+	DFF DCAUSE1 (.D(next[1]), .CLK(clk), .Q(cause[1]));
+	DFF DCAUSE2 (.D(next[2]), .CLK(clk), .Q(cause[2]));
+	DFF DCAUSE3 (.D(next[3]), .CLK(clk), .Q(cause[3]));
+	DFF DCAUSE4 (.D(next[4]), .CLK(clk), .Q(cause[4]));
+	DFF DCAUSE5 (.D(next[5]), .CLK(clk), .Q(cause[5]));
+endmodule
@@ -3,6 +3,9 @@
 * 											*
 * Requisites								*
 *	sreg16.v								*
+*	reg16.v									*
+*	count4.v								*
+*	lcount5.v								*
 *	edecode4.v								*
 *											*
 * Requisite to								*
@@ -18,11 +21,25 @@ a slave.  It takes a chip select (write enable), clock, and data line from the
 master, and when enabled, shifts data in from the data line.  It writes the received
 data to the rest of the device when the enable drops low
 
-FIXED!!! :-): As the clock from the MSP only runs when data is being sent, an extra byte must be 'written'
-(while keeping chpsel high) for the circuit to realize that transmission is finished.  This should
-be replaced with a system that does not need this (a way of doing this is described in Andreas' 
-notes, talk to him if he left before implementing it).  This would mean moving the load signal to the
-main (256Mhz) clock
+Frames are one or more 16 bit words in a single chip select assertion:
+	word 0:		[15:14] board, [13:11] signal, [10:0] value
+	word n:		[10:0] value for signal + n ([15:11] are ignored)
+so a frame of one word is the original protocol.  Each word is written to the board
+register as it arrives, but the signal modules only pick the new values up (commit) when
+chip select goes high, so every register in a burst takes effect in the same PWM cycle.
+
+The shift register runs on mspclk, which only runs while a byte is being sent.  A bit
+counter on mspclk copies every 16th bit's worth of shift register into the word register
+and flips a toggle; the toggle and nchpsel are synchronised into clk (two flip-flops
+each) and everything after that happens on the main clock.  The word register holds for
+the next 16 bits (about 8us), which is plenty for clk.  No extra byte is needed after
+chip select goes high, but it must stay high for at least 2 clk cycles (50ns) between
+frames.  That is what it takes for DCS1 to catch it high at least once, allowing for
+DCS1 going metastable on the first edge.  From that one sample on, the clearing of active
+(ncs2) and the commit (ncs4, after the last load) run down the delay chain on their own,
+whether or not chip select is still high.  Chip select must also not go high before the
+last mspclk edge of the frame, or the last word is never counted.
+Bits left over at the end of a frame (less than a whole word) are dropped.
 */
 
 /* Copyright (C) Andreas Gotterba, 2009 */ 
@@ -53,7 +70,8 @@ module inblock (
 	clk,		// the regular clock
 	mspclk,		// the slow clock from the master SPI device
 	serialin,	// the data from the master SPI device
-	nchpsel		// the chip select (write enable) from the master SPI device (active low)
+	nchpsel,	// the chip select (write enable) from the master SPI device (active low)
+	commit		// end of frame: the boards should apply the registers loaded in it
 	);
 
 	output [15:0] data;
@@ -61,31 +79,82 @@ module inblock (
 	output load1;
 	output load2;
 	output load3;
+	output commit;
 	
 	input clk;
 	input mspclk;
 	input serialin;
 	input nchpsel;
 	
-	wire chpsel;		// invert the n chip select line  for edge detection (active high)
-	wire chpsel1;		// delay the chip select line one clock cycle so I can detect its falling edge
-	wire chpsel2;		// delay it another cycle for good measure, I don't know how long it will take for everything to be written
-	wire chpseld;		// the or of chpsel1 and chpsel2, so that two cycles are availible to load
+	wire chpsel;		// invert the n chip select line (active high), enables the shift register
+	wire [15:0] shift;	// the shift register
+	wire [3:0] bits;	// bits shifted in so far in this word
+	wire wordend;		// this mspclk edge shifts in the last bit of a word
+	wire [15:0] word;	// the last complete word, stable for the next 16 mspclk cycles
+	wire wtog, nwtog;	// flips every time a word completes
+
+	wire w1, w2, w3;	// wtog synchronised into clk, and delayed for the edge detector
+	wire strobe;		// one clk cycle for each new word
+	wire active, nactive;	// set after the first word of a frame
+	wire actset, actnext;
+	wire first, next;	// strobe for the first word / the ones after it
+	wire l1, l2;		// strobe delayed, so the load can be held for two cycles
 	wire loaden;		// load (decode the board address and send the data on its way)
-	wire clear;			// clear the shift register
+	wire [4:0] addr;	// board and signal address of the current word
+
+	wire ncs1;			// nchpsel synchronised into clk
+	wire ncs2;			// second synchroniser stage, safe to use
+	wire ncs3, ncs4, ncs5;	// delayed, so the commit comes after the last load
+	wire nncs2, nncs5;	// inverted for the edge detectors
 	
 	//the input shift register
-	sreg16 SHIFT( .clock(mspclk), .enable(chpsel), .shiftin(serialin), .sclr(clear), .q( data[15:0]));
-
 	not (chpsel, nchpsel);	//invert the active low chip select line
-	DFF DCS1 (.D(chpsel), .CLK(clk), .Q(chpsel1)); //negative edge detector on chpsel
-	DFF DCS2 (.D(chpsel1), .CLK(clk), .Q(chpsel2)); //two clock cycle dely for good measure
-	or (chpseld, chpsel1, chpsel2);
-	and (loaden, nchpsel, chpseld); // To load data, chpsel must go from low to high. Hold this for two cycles, as the load net is large and may be slow
-	and (clear, nchpsel, chpsel2);  //clear only after the two cycles
+	sreg16 SHIFT( .clock(mspclk), .enable(chpsel), .shiftin(serialin), .sclr(1'b0), .q(shift[15:0]));
+
+	//count the bits, held at zero while chip select is high
+	count4 BITS (.clock(mspclk), .cnt_en(chpsel), .aclr(nchpsel), .q(bits[3:0]));
+	and (wordend, chpsel, bits[0], bits[1], bits[2], bits[3]);
+
+	//keep the word (including the bit arriving now) and tell the fast clock about it
+	reg16 WORD (.CLK(mspclk), .ENA(wordend), .D({shift[14:0], serialin}), .Q(word[15:0]));
+	not (nwtog, wtog);
+	DFFE WTOG (.D(nwtog), .CLK(mspclk), .ENA(wordend), .Q(wtog));
 
-	edecode4 BOARDSEL(	.data(data[15:14]), .enable(loaden), .eq0(countglobal), 
+	//bring the word toggle into the fast clock domain
+	DFF DW1 (.D(wtog), .CLK(clk), .Q(w1));
+	DFF DW2 (.D(w1), .CLK(clk), .Q(w2));
+	DFF DW3 (.D(w2), .CLK(clk), .Q(w3));
+	xor (strobe, w2, w3);
+
+	//bring the chip select into the fast clock domain
+	DFF DCS1 (.D(nchpsel), .CLK(clk), .Q(ncs1));
+	DFF DCS2 (.D(ncs1), .CLK(clk), .Q(ncs2));
+	DFF DCS3 (.D(ncs2), .CLK(clk), .Q(ncs3));
+	DFF DCS4 (.D(ncs3), .CLK(clk), .Q(ncs4));
+	DFF DCS5 (.D(ncs4), .CLK(clk), .Q(ncs5));
+	not (nncs2, ncs2);
+	not (nncs5, ncs5);
+
+	//the first word of a frame carries the address, the rest auto-increment it
+	or (actset, active, strobe);
+	and (actnext, actset, nncs2);	//cleared while chip select is high
+	DFF DACT (.D(actnext), .CLK(clk), .Q(active));
+	not (nactive, active);
+	and (first, strobe, nactive);
+	and (next, strobe, active);
+	lcount5 ADDR (.clock(clk), .sload(first), .cnt_en(next), .data(word[15:11]), .q(addr[4:0]));
+
+	assign data[15:0] = {addr[4:0], word[10:0]};
+
+	//the address is valid the cycle after the strobe. Hold the load for two cycles, as the load net is large and may be slow
+	DFF DL1 (.D(strobe), .CLK(clk), .Q(l1));
+	DFF DL2 (.D(l1), .CLK(clk), .Q(l2));
+	or (loaden, l1, l2);
+	
+	edecode4 BOARDSEL(	.data(addr[4:3]), .enable(loaden), .eq0(countglobal), 
 						.eq1(load1), .eq2(load2), .eq3(load3));
-//the load pulse will last for 1 mspclk cycle, which will contain several fast clk cycles	
-//if this is a problem, could register it so that its clock is converted
-endmodule	
\ No newline at end of file
+
+	//commit once chip select has been high for long enough for the last load to finish
+	//(also once at power up, when the registers are all zero anyway)
+	and (commit, ncs4, nncs5);
+endmodule
@@ -0,0 +1,128 @@
+// megafunction wizard: %LPM_COUNTER%
+// GENERATION: STANDARD
+// VERSION: WM1.0
+// MODULE: lpm_counter 
+
+// ============================================================
+// File Name: lcount5.v
+// Megafunction Name(s):
+// 			lpm_counter
+// ============================================================
+// ************************************************************
+// THIS IS A WIZARD-GENERATED FILE. DO NOT EDIT THIS FILE!
+//
+// 4.2 Build 178 01/19/2005 SP 1 SJ Web Edition
+// ************************************************************
+
+
+//Copyright (C) 1991-2005 Altera Corporation
+//Any  megafunction  design,  and related netlist (encrypted  or  decrypted),
+//support information,  device programming or simulation file,  and any other
+//associated  documentation or information  provided by  Altera  or a partner
+//under  Altera's   Megafunction   Partnership   Program  may  be  used  only
+//to program  PLD  devices (but not masked  PLD  devices) from  Altera.   Any
+//other  use  of such  megafunction  design,  netlist,  support  information,
+//device programming or simulation file,  or any other  related documentation
+//or information  is prohibited  for  any  other purpose,  including, but not
+//limited to  modification,  reverse engineering,  de-compiling, or use  with
+//any other  silicon devices,  unless such use is  explicitly  licensed under
+//a separate agreement with  Altera  or a megafunction partner.  Title to the
+//intellectual property,  including patents,  copyrights,  trademarks,  trade
+//secrets,  or maskworks,  embodied in any such megafunction design, netlist,
+//support  information,  device programming or simulation file,  or any other
+//related documentation or information provided by  Altera  or a megafunction
+//partner, remains with Altera, the megafunction partner, or their respective
+//licensors. No other licenses, including any licenses needed under any third
+//party's intellectual property, are provided herein.
+
+
+// synopsys translate_off
+`timescale 1 ps / 1 ps
+// synopsys translate_on
+module lcount5 (
+	clock,
+	cnt_en,
+	data,
+	sload,
+	q);
+
+	input	  clock;
+	input	  cnt_en;
+	input	[4:0]  data;
+	input	  sload;
+	output	[4:0]  q;
+
+	wire [4:0] sub_wire0;
+	wire [4:0] q = sub_wire0[4:0];
+
+	lpm_counter	lpm_counter_component (
+				.sload (sload),
+				.clock (clock),
+				.data (data),
+				.cnt_en (cnt_en),
+				.q (sub_wire0)
+				// synopsys translate_off
+				,
+				.aclr (),
+				.aload (),
+				.aset (),
+				.cin (),
+				.clk_en (),
+				.cout (),
+				.eq (),
+				.sclr (),
+				.sset (),
+				.updown ()
+				// synopsys translate_on
+				);
+	defparam
+		lpm_counter_component.lpm_width = 5,
+		lpm_counter_component.lpm_type = "LPM_COUNTER",
+		lpm_counter_component.lpm_direction = "UP";
+
+
+endmodule
+
+// ============================================================
+// CNX file retrieval info
+// ============================================================
+// Retrieval info: PRIVATE: nBit NUMERIC "5"
+// Retrieval info: PRIVATE: Direction NUMERIC "0"
+// Retrieval info: PRIVATE: CLK_EN NUMERIC "0"
+// Retrieval info: PRIVATE: CNT_EN NUMERIC "1"
+// Retrieval info: PRIVATE: ModulusCounter NUMERIC "0"
+// Retrieval info: PRIVATE: ModulusValue NUMERIC "0"
+// Retrieval info: PRIVATE: CarryIn NUMERIC "0"
+// Retrieval info: PRIVATE: CarryOut NUMERIC "0"
+// Retrieval info: PRIVATE: SCLR NUMERIC "0"
+// Retrieval info: PRIVATE: SLOAD NUMERIC "1"
+// Retrieval info: PRIVATE: SSET NUMERIC "0"
+// Retrieval info: PRIVATE: SSET_ALL1 NUMERIC "1"
+// Retrieval info: PRIVATE: SSETV NUMERIC "0"
+// Retrieval info: PRIVATE: ACLR NUMERIC "0"
+// Retrieval info: PRIVATE: ALOAD NUMERIC "0"
+// Retrieval info: PRIVATE: ASET NUMERIC "0"
+// Retrieval info: PRIVATE: ASET_ALL1 NUMERIC "1"
+// Retrieval info: PRIVATE: ASETV NUMERIC "0"
+// Retrieval info: CONSTANT: LPM_WIDTH NUMERIC "5"
+// Retrieval info: CONSTANT: LPM_TYPE STRING "LPM_COUNTER"
+// Retrieval info: CONSTANT: LPM_DIRECTION STRING "UP"
+// Retrieval info: USED_PORT: clock 0 0 0 0 INPUT NODEFVAL clock
+// Retrieval info: USED_PORT: q 0 0 5 0 OUTPUT NODEFVAL q[4..0]
+// Retrieval info: USED_PORT: cnt_en 0 0 0 0 INPUT NODEFVAL cnt_en
+// Retrieval info: USED_PORT: data 0 0 5 0 INPUT NODEFVAL data[4..0]
+// Retrieval info: USED_PORT: sload 0 0 0 0 INPUT NODEFVAL sload
+// Retrieval info: CONNECT: @clock 0 0 0 0 clock 0 0 0 0
+// Retrieval info: CONNECT: q 0 0 5 0 @q 0 0 5 0
+// Retrieval info: CONNECT: @cnt_en 0 0 0 0 cnt_en 0 0 0 0
+// Retrieval info: CONNECT: @data 0 0 5 0 data 0 0 5 0
+// Retrieval info: CONNECT: @sload 0 0 0 0 sload 0 0 0 0
+// Retrieval info: LIBRARY: lpm lpm.lpm_components.all
+// Retrieval info: GEN_FILE: TYPE_NORMAL lcount5.v TRUE
+// Retrieval info: GEN_FILE: TYPE_NORMAL lcount5.inc FALSE
+// Retrieval info: GEN_FILE: TYPE_NORMAL lcount5.cmp FALSE
+// Retrieval info: GEN_FILE: TYPE_NORMAL lcount5.bsf FALSE
+// Retrieval info: GEN_FILE: TYPE_NORMAL lcount5_inst.v FALSE
+// Retrieval info: GEN_FILE: TYPE_NORMAL lcount5_bb.v FALSE
+// Retrieval info: GEN_FILE: TYPE_NORMAL lcount5_waveforms.html FALSE
+// Retrieval info: GEN_FILE: TYPE_NORMAL lcount5_wave*.jpg FALSE
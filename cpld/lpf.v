@@ -58,9 +58,9 @@ module lpf (
 	wire	ubuff23;
 
 	//The low pass filter: if there is a difference between the 3 registers, outputs the two that agree	
-	DFF (.D(in), .CLK(clk), .Q(ubuff1)); 
-	DFF (.D(ubuff1), .CLK(clk), .Q(ubuff2)); 
-	DFF (.D(ubuff2), .CLK(clk), .Q(ubuff3));
+	DFF DBUF1 (.D(in), .CLK(clk), .Q(ubuff1)); 
+	DFF DBUF2 (.D(ubuff1), .CLK(clk), .Q(ubuff2)); 
+	DFF DBUF3 (.D(ubuff2), .CLK(clk), .Q(ubuff3));
 	and otw (ubuff12, ubuff1, ubuff2);		
 	and oth (ubuff13, ubuff1, ubuff3);		
 	and tth (ubuff23, ubuff2, ubuff3);		
@@ -0,0 +1,87 @@
+/********************************************
+* outblock.v   								*
+* 											*
+* Requisites								*
+*	sreg64.v								*
+*											*
+* Requisite to								*
+*	NgControlCpld.v							*
+*											*
+*********************************************
+The SPI output to the MSP430 (serialout).  When chip select goes low, a
+snapshot of the status is loaded into a 64 bit shift register, and it is
+shifted out MSB first, one bit after each rising edge of mspclk (the edge
+both ends sample on), for as long as the frame lasts.  The MSP only gets the
+first 16 bits of a one word frame; it has to send a frame of at least four
+words to read the lot.  The snapshot, big-endian:
+	byte 0:		fault causes, latched since the last FSReset (see faults.v),
+				bit 6 is a shutdown by the current limiter (board.v, any board)
+	byte 1:		faults active now, bit 7 is SD, bit 6 is set while the
+				current limiter is cutting pulses short on any board
+	word 1:		main_length applied on board 1 ([10:0])
+	word 2:		period ([10:0])
+	word 3:		switching cycles (wraps)
+
+Everything is done on clk: mspclk and nchpsel are synchronised and their
+edges detected, which is fine as long as a bit lasts a lot longer than a few
+clk cycles (about 21 at 1.8MHz SPI and 40MHz clk), and the first mspclk edge
+comes at least 3 clk cycles after chip select goes low.
+*/
+
+/* Copyright (C) agent, 2026 */ 
+
+/* 
+ * This file is part of the UNSWMPPTNG firmware.
+ * 
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ 
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ 
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+module outblock (
+	serialout,	// data to the MSP
+	clk,		// the regular clock
+	mspclk,		// the slow clock from the master SPI device
+	nchpsel,	// the chip select from the master SPI device (active low)
+	status[63:0]	// what to send
+	);
+
+	output serialout;
+
+	input clk;
+	input mspclk;
+	input nchpsel;
+	input [63:0] status;
+
+	wire ncs1, ncs2, ncs3;	// nchpsel synchronised into clk, and delayed for the edge detector
+	wire nncs2;
+	wire m1, m2, m3;		// mspclk synchronised into clk, and delayed for the edge detector
+	wire nm3;
+	wire load;				// chip select just went low: take the snapshot
+	wire shift;				// mspclk just went high: on to the next bit
+	wire enable;
+
+	DFF DCS1 (.D(nchpsel), .CLK(clk), .Q(ncs1));
+	DFF DCS2 (.D(ncs1), .CLK(clk), .Q(ncs2));
+	DFF DCS3 (.D(ncs2), .CLK(clk), .Q(ncs3));
+	not (nncs2, ncs2);
+	and (load, nncs2, ncs3);
+
+	DFF DM1 (.D(mspclk), .CLK(clk), .Q(m1));
+	DFF DM2 (.D(m1), .CLK(clk), .Q(m2));
+	DFF DM3 (.D(m2), .CLK(clk), .Q(m3));
+	not (nm3, m3);
+	and (shift, m2, nm3, nncs2);
+
+	or (enable, load, shift);
+	sreg64 OUT (.clock(clk), .enable(enable), .load(load), .data(status[63:0]), .shiftout(serialout));
+endmodule
@@ -0,0 +1,65 @@
+/********************************************
+* reg16.v   								*
+*											*
+* Requisites								*
+*	<none>									*
+*											*
+* Requisite to								*
+*	inblock.v								*
+*											*
+*											*
+*********************************************
+A 16 bit wide register with an enable, built the same way as reg11.v, for the
+word inblock keeps from the mspclk domain.
+*/
+
+/* Copyright (C) agent, 2026 */ 
+
+/* 
+ * This file is part of the UNSWMPPTNG firmware.
+ * 
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ 
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ 
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+module reg16 (
+	D[15:0],		// input data
+	CLK,		// the clock
+	ENA,		// enable the loading of new data
+	Q[15:0]		// output data
+	);
+	
+	input [15:0] D;
+	input CLK;
+	input ENA;
+	output [15:0] Q;
+	
+	//A whole buch of flip-flops
+	DFFE FF0 (.CLK(CLK), .ENA(ENA), .D(D[0]), .Q(Q[0]));
+	DFFE FF1 (.CLK(CLK), .ENA(ENA), .D(D[1]), .Q(Q[1]));
+	DFFE FF2 (.CLK(CLK), .ENA(ENA), .D(D[2]), .Q(Q[2]));
+	DFFE FF3 (.CLK(CLK), .ENA(ENA), .D(D[3]), .Q(Q[3]));
+	DFFE FF4 (.CLK(CLK), .ENA(ENA), .D(D[4]), .Q(Q[4]));
+	DFFE FF5 (.CLK(CLK), .ENA(ENA), .D(D[5]), .Q(Q[5]));
+	DFFE FF6 (.CLK(CLK), .ENA(ENA), .D(D[6]), .Q(Q[6]));
+	DFFE FF7 (.CLK(CLK), .ENA(ENA), .D(D[7]), .Q(Q[7]));
+	DFFE FF8 (.CLK(CLK), .ENA(ENA), .D(D[8]), .Q(Q[8]));
+	DFFE FF9 (.CLK(CLK), .ENA(ENA), .D(D[9]), .Q(Q[9]));
+	DFFE FF10 (.CLK(CLK), .ENA(ENA), .D(D[10]), .Q(Q[10]));
+	DFFE FF11 (.CLK(CLK), .ENA(ENA), .D(D[11]), .Q(Q[11]));
+	DFFE FF12 (.CLK(CLK), .ENA(ENA), .D(D[12]), .Q(Q[12]));
+	DFFE FF13 (.CLK(CLK), .ENA(ENA), .D(D[13]), .Q(Q[13]));
+	DFFE FF14 (.CLK(CLK), .ENA(ENA), .D(D[14]), .Q(Q[14]));
+	DFFE FF15 (.CLK(CLK), .ENA(ENA), .D(D[15]), .Q(Q[15]));
+
+endmodule
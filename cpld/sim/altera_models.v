@@ -0,0 +1,192 @@
+/********************************************
+* altera_models.v							*
+*											*
+* Requisites								*
+*	<none>									*
+*											*
+* Requisite to								*
+*	the testbenches in this directory		*
+*											*
+*********************************************
+Behavioural models of the Altera primitives and LPM megafunctions the design
+uses, so that it can be simulated without Quartus.  Only the parts of each
+function the wizard files actually use are modelled; the other ports are
+there so the wizard files connect, and are ignored.
+
+As in the MAX II, every register powers up low, and an unconnected CLRN, PRN
+or ENA on a DFF or DFFE is taken as high.
+*/
+
+/* Copyright (C) agent, 2026 */ 
+
+/* 
+ * This file is part of the UNSWMPPTNG firmware.
+ * 
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ 
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ 
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+`timescale 1 ps / 1 ps
+
+module DFF (D, CLK, CLRN, PRN, Q);
+	input D, CLK, CLRN, PRN;
+	output Q;
+	tri1 CLRN, PRN;
+	reg Q;
+
+	initial Q = 1'b0;
+	always @(posedge CLK or negedge CLRN or negedge PRN)
+		if (!CLRN)
+			Q <= 1'b0;
+		else if (!PRN)
+			Q <= 1'b1;
+		else
+			Q <= D;
+endmodule
+
+module DFFE (D, CLK, ENA, CLRN, PRN, Q);
+	input D, CLK, ENA, CLRN, PRN;
+	output Q;
+	tri1 ENA, CLRN, PRN;
+	reg Q;
+
+	initial Q = 1'b0;
+	always @(posedge CLK or negedge CLRN or negedge PRN)
+		if (!CLRN)
+			Q <= 1'b0;
+		else if (!PRN)
+			Q <= 1'b1;
+		else if (ENA)
+			Q <= D;
+endmodule
+
+// Up counter: aclr, then sclr, then sload, then cnt_en
+module lpm_counter (clock, cnt_en, sclr, aclr, sload, data, q,
+					aload, aset, cin, clk_en, cout, eq, sset, updown);
+	parameter lpm_width = 1;
+	parameter lpm_type = "LPM_COUNTER";
+	parameter lpm_direction = "UP";
+
+	input clock, cnt_en, sclr, aclr, sload;
+	input [lpm_width-1:0] data;
+	output [lpm_width-1:0] q;
+	input aload, aset, cin, clk_en, sset, updown;
+	output cout;
+	output [15:0] eq;
+	tri1 cnt_en;
+	tri0 sclr, aclr, sload;
+	reg [lpm_width-1:0] q;
+
+	initial q = 0;
+	always @(posedge clock or posedge aclr)
+		if (aclr)
+			q <= 0;
+		else if (sclr)
+			q <= 0;
+		else if (sload)
+			q <= data;
+		else if (cnt_en)
+			q <= q + 1'b1;
+
+	assign cout = &q;
+	assign eq = 16'b0;
+endmodule
+
+module lpm_add_sub (dataa, datab, result, cout, aclr, add_sub, cin, clken, clock, overflow);
+	parameter lpm_width = 1;
+	parameter lpm_direction = "ADD";
+	parameter lpm_type = "LPM_ADD_SUB";
+	parameter lpm_hint = "UNUSED";
+
+	input [lpm_width-1:0] dataa, datab;
+	output [lpm_width-1:0] result;
+	output cout, overflow;
+	input aclr, add_sub, cin, clken, clock;
+
+	// cout is the carry when adding, and not borrow when subtracting
+	wire [lpm_width:0] sum = (lpm_direction == "SUB") ? {1'b0, dataa} + {1'b0, ~datab} + 1'b1
+													   : {1'b0, dataa} + {1'b0, datab};
+	assign result = sum[lpm_width-1:0];
+	assign cout = sum[lpm_width];
+	assign overflow = 1'b0;
+endmodule
+
+module lpm_compare (dataa, datab, aeb, agb, ageb, alb, aleb, aneb, aclr, clken, clock);
+	parameter lpm_width = 1;
+	parameter lpm_type = "LPM_COMPARE";
+	parameter lpm_representation = "UNSIGNED";
+
+	input [lpm_width-1:0] dataa, datab;
+	output aeb, agb, ageb, alb, aleb, aneb;
+	input aclr, clken, clock;
+
+	assign aeb = dataa == datab;
+	assign agb = dataa > datab;
+	assign ageb = dataa >= datab;
+	assign alb = dataa < datab;
+	assign aleb = dataa <= datab;
+	assign aneb = dataa != datab;
+endmodule
+
+module lpm_decode (data, enable, eq, aclr, clken, clock);
+	parameter lpm_width = 1;
+	parameter lpm_decodes = 2;
+	parameter lpm_type = "LPM_DECODE";
+
+	input [lpm_width-1:0] data;
+	input enable;
+	output [lpm_decodes-1:0] eq;
+	input aclr, clken, clock;
+	tri1 enable;
+
+	assign eq = enable ? ({{(lpm_decodes-1){1'b0}}, 1'b1} << data) : {lpm_decodes{1'b0}};
+endmodule
+
+module lpm_mux (data, sel, result, aclr, clken, clock);
+	parameter lpm_size = 2;
+	parameter lpm_widths = 1;
+	parameter lpm_width = 1;
+	parameter lpm_type = "LPM_MUX";
+
+	input [lpm_size*lpm_width-1:0] data;
+	input [lpm_widths-1:0] sel;
+	output [lpm_width-1:0] result;
+	input aclr, clken, clock;
+
+	assign result = data >> (sel * lpm_width);
+endmodule
+
+// Left (towards the MSB) shift register: sclr, then enable with load or shift
+module lpm_shiftreg (clock, enable, shiftin, sclr, load, data, q, shiftout, aclr, aset, sset);
+	parameter lpm_width = 1;
+	parameter lpm_type = "LPM_SHIFTREG";
+	parameter lpm_direction = "LEFT";
+
+	input clock, enable, shiftin, sclr, load;
+	input [lpm_width-1:0] data;
+	output [lpm_width-1:0] q;
+	output shiftout;
+	input aclr, aset, sset;
+	tri1 enable;
+	tri0 shiftin, sclr, load;
+	reg [lpm_width-1:0] q;
+
+	initial q = 0;
+	always @(posedge clock)
+		if (sclr)
+			q <= 0;
+		else if (enable)
+			q <= load ? data : {q[lpm_width-2:0], shiftin};
+
+	assign shiftout = q[lpm_width-1];
+endmodule
@@ -0,0 +1,288 @@
+/********************************************
+* tb_phases.v								*
+*											*
+* Requisites								*
+*	altera_models.v							*
+*	everything in NgControlCpld.qsf			*
+*											*
+*********************************************
+Self checking testbench for NgControlCpld built with PHASES = 3.  Boards 2 and
+3 are given phase registers a third and two thirds of a cycle behind board 1,
+less the 2 clk the phase lock takes, as fpga_set_phases() does.  The aux rising
+edges of the three boards are timed in clk cycles, sampling on the falling edge
+of clk, as in tb_top.v.
+
+Covered: the slaves' period and offset behind board 1, their own main length,
+a shed board (aux length and main length 0), and the current limiter shutting
+every board down.  Prints PASS, or FAIL with a count; see the makefile.
+*/
+
+/* Copyright (C) agent, 2026 */
+
+/*
+ * This file is part of the UNSWMPPTNG firmware.
+ *
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+`timescale 1 ns / 100 ps
+
+module tb_phases;
+
+	// Register values, as the firmware's defaults
+	parameter PERIOD = 1300;
+	parameter AUX_LENGTH = 55;
+	parameter AUX_OVERLAP = 8;
+	parameter DEADTIME = 25;
+	parameter MAIN = 400;
+
+	// A third of a cycle, and the delay of the phase lock
+	parameter OFFSET = (PERIOD + 5) / 3;
+	parameter LOCK = 2;
+
+	parameter SPI_HALF = 271;	// ns, half a bit at 1.84MHz
+
+	reg clk;
+	reg serialin, mspclk, nchpsel;
+	reg FSReset, nFPGAReset, FPGAEnable, nMSPReset;
+	reg nVoltFault, nReg15Fault, nReg5Fault, nCurrentFault;
+	wire serialout, LED1, LED2, nSD;
+	wire aux, main, diode, SD, aux2, main2, diode2, SD2, aux3, main3, diode3, SD3;
+
+	NgControlCpld #(.PHASES(3)) dut (.clk(clk), .ste(1'b0), .serialin(serialin), .serialout(serialout),
+					   .mspclk(mspclk), .nchpsel(nchpsel), .gpio1(1'b0), .gpio2(1'b0),
+					   .LED1(LED1), .LED2(LED2), .nSD(nSD), .FSReset(FSReset),
+					   .nFPGAReset(nFPGAReset), .FPGAEnable(FPGAEnable), .nMSPReset(nMSPReset),
+					   .nVoltFault(nVoltFault), .nReg15Fault(nReg15Fault), .nReg5Fault(nReg5Fault),
+					   .nCurrentFault(nCurrentFault), .aux(aux), .main(main), .diode(diode), .SD(SD),
+					   .aux2(aux2), .main2(main2), .diode2(diode2), .SD2(SD2),
+					   .aux3(aux3), .main3(main3), .diode3(diode3), .SD3(SD3));
+
+	initial clk = 1'b0;
+	always #12.5 clk = ~clk;
+
+	// An edge that never comes would leave vvp running for good; the run takes
+	// well under this
+	initial begin
+		#5000000;
+		$display("FAIL tb_phases: timeout");
+		$finish;
+	end
+
+	integer errors;
+
+	task check;
+		input ok;
+		input [8*48-1:0] what;
+		input integer got;
+		input integer want;
+		begin
+			if (ok)
+				$display("  ok    %0s: %0d", what, got);
+			else begin
+				$display("  FAIL  %0s: %0d, expected %0d", what, got, want);
+				errors = errors + 1;
+			end
+		end
+	endtask
+
+	task bench;
+		input [8*48-1:0] what;
+		input integer clks;
+		begin
+			$display("  bench %0s: %0d clk", what, clks);
+		end
+	endtask
+
+	//-------------------------------------------------------------------
+	// Edge monitor: the clk count of the last aux rise on each board, the
+	// period up to it, and the main width of the cycle before it
+
+	event cycle_done;			// board 1's aux rose
+	integer t;
+	integer rise1, rise2, rise3, period1, period2, period3;
+	integer main1_c, main2_c, main3_c, last_main1, last_main2, last_main3;
+	integer aux3_c, last_aux3;
+	reg prev1, prev2, prev3;
+
+	initial begin
+		t = 0;
+		rise1 = 0; rise2 = 0; rise3 = 0;
+		period1 = 0; period2 = 0; period3 = 0;
+		main1_c = 0; main2_c = 0; main3_c = 0; aux3_c = 0;
+		prev1 = 1'b0; prev2 = 1'b0; prev3 = 1'b0;
+	end
+
+	always @(negedge clk) begin
+		t = t + 1;
+		if (aux && !prev1) begin
+			period1 = t - rise1; rise1 = t;
+			last_main1 = main1_c; main1_c = 0;
+			last_main3 = main3_c; main3_c = 0;
+			last_aux3 = aux3_c; aux3_c = 0;
+			-> cycle_done;
+		end
+		if (aux2 && !prev2) begin
+			period2 = t - rise2; rise2 = t;
+			last_main2 = main2_c; main2_c = 0;
+		end
+		if (aux3 && !prev3) begin
+			period3 = t - rise3; rise3 = t;
+		end
+		if (main) main1_c = main1_c + 1;
+		if (main2) main2_c = main2_c + 1;
+		if (main3) main3_c = main3_c + 1;
+		if (aux3) aux3_c = aux3_c + 1;
+		prev1 = aux; prev2 = aux2; prev3 = aux3;
+	end
+
+	task skip_cycles;
+		input integer n;
+		begin
+			repeat (n) @(cycle_done);
+		end
+	endtask
+
+	//-------------------------------------------------------------------
+	// SPI, as the MSP430 master
+
+	reg [15:0] tx [0:7];
+
+	function [15:0] spi_word;
+		input [1:0] board;
+		input [2:0] signal;
+		input [10:0] value;
+		spi_word = {board, signal, value};
+	endfunction
+
+	task spi_frame;
+		input integer words;
+		integer w, b;
+		begin
+			#500;
+			nchpsel = 1'b0;
+			#200;
+			for (w = 0; w < words; w = w + 1)
+				for (b = 15; b >= 0; b = b - 1) begin
+					serialin = tx[w][b];
+					#SPI_HALF mspclk = 1'b1;
+					#SPI_HALF mspclk = 1'b0;
+				end
+			#100 nchpsel = 1'b1;
+		end
+	endtask
+
+	// Every register of one board, phase included
+	task board_frame;
+		input [1:0] board;
+		input [10:0] aux_length;
+		input [10:0] main_length;
+		input [10:0] phase;
+		begin
+			tx[0] = spi_word(board, 3'd0, PERIOD);
+			tx[1] = aux_length;
+			tx[2] = AUX_OVERLAP;
+			tx[3] = main_length;
+			tx[4] = 0;
+			tx[5] = DEADTIME;
+			tx[6] = phase;
+			spi_frame(7);
+		end
+	endtask
+
+	task fs_reset;
+		begin
+			@(negedge clk);
+			FSReset = 1'b1;
+			repeat (10) @(negedge clk);
+			FSReset = 1'b0;
+			repeat (10) @(negedge clk);
+		end
+	endtask
+
+	//-------------------------------------------------------------------
+
+	integer i;
+
+	initial begin
+		errors = 0;
+		serialin = 1'b0; mspclk = 1'b0; nchpsel = 1'b1;
+		FSReset = 1'b0; nFPGAReset = 1'b1; FPGAEnable = 1'b1; nMSPReset = 1'b1;
+		nVoltFault = 1'b1; nReg15Fault = 1'b1; nReg5Fault = 1'b1; nCurrentFault = 1'b1;
+
+		repeat (10) @(negedge clk);
+		check(SD == 1'b1 && SD2 == 1'b1 && SD3 == 1'b1, "power up: SD", SD & SD2 & SD3, 1);
+
+		$display("interleaved");
+		board_frame(2'd1, AUX_LENGTH, MAIN, 0);
+		board_frame(2'd2, AUX_LENGTH, MAIN, OFFSET - LOCK);
+		board_frame(2'd3, AUX_LENGTH, MAIN, 2 * OFFSET - LOCK);
+		fs_reset;
+		check(SD == 1'b0 && SD2 == 1'b0 && SD3 == 1'b0, "after FSReset: SD", SD | SD2 | SD3, 0);
+
+		skip_cycles(3);
+		@(negedge clk);
+		check(period1 == PERIOD + 5, "board 1 period", period1, PERIOD + 5);
+		check(period2 == PERIOD + 5, "board 2 period", period2, PERIOD + 5);
+		check(period3 == PERIOD + 5, "board 3 period", period3, PERIOD + 5);
+		// rise2 and rise3 are from the cycle before board 1's last one
+		check(rise2 - (rise1 - period1) == OFFSET, "board 1 to board 2 aux rise",
+			  rise2 - (rise1 - period1), OFFSET);
+		check(rise3 - (rise1 - period1) == 2 * OFFSET, "board 1 to board 3 aux rise",
+			  rise3 - (rise1 - period1), 2 * OFFSET);
+		check(last_main1 == MAIN - 1 && last_main2 == MAIN - 1, "main width, boards 1 and 2",
+			  last_main2, MAIN - 1);
+		bench("board 1 to board 2", rise2 - (rise1 - period1));
+		bench("board 1 to board 3", rise3 - (rise1 - period1));
+
+		$display("own main length");
+		tx[0] = spi_word(2'd2, 3'd3, 300);
+		spi_frame(1);
+		skip_cycles(3);
+		check(last_main2 == 299, "board 2 main width", last_main2, 299);
+		check(last_main1 == MAIN - 1, "board 1 main width", last_main1, MAIN - 1);
+
+		$display("shed");
+		tx[0] = spi_word(2'd3, 3'd1, 0);
+		tx[1] = AUX_OVERLAP;
+		tx[2] = 0;
+		spi_frame(3);
+		skip_cycles(3);
+		check(last_aux3 == 0 && last_main3 == 0, "shed board: aux and main on", last_aux3 + last_main3, 0);
+		check(last_main1 == MAIN - 1, "board 1 main width", last_main1, MAIN - 1);
+
+		$display("current limit shuts every board down");
+		nCurrentFault = 1'b0;
+		i = 0;
+		while (!SD && i < 10 * (PERIOD + 5)) begin
+			@(posedge clk);
+			#1 i = i + 1;
+		end
+		check(SD == 1'b1 && SD2 == 1'b1 && SD3 == 1'b1, "held limit: SD", SD & SD2 & SD3, 1);
+		nCurrentFault = 1'b1;
+		fs_reset;
+		check(SD == 1'b0 && SD2 == 1'b0 && SD3 == 1'b0, "after FSReset: SD", SD | SD2 | SD3, 0);
+		skip_cycles(3);
+		@(negedge clk);
+		check(rise2 - (rise1 - period1) == OFFSET, "board 1 to board 2 after restart",
+			  rise2 - (rise1 - period1), OFFSET);
+
+		if (errors == 0)
+			$display("PASS tb_phases");
+		else
+			$display("FAIL tb_phases: %0d errors", errors);
+		$finish;
+	end
+
+endmodule
@@ -0,0 +1,382 @@
+/********************************************
+* tb_top.v									*
+*											*
+* Requisites								*
+*	altera_models.v							*
+*	everything in NgControlCpld.qsf			*
+*											*
+*********************************************
+Self checking testbench for the whole CPLD.  It talks to NgControlCpld the way
+the MSP430 does: SPI frames at 1.84MHz (UBR00 = 4 from 7.3728MHz) with the data
+changing on the falling edge of mspclk, plus the FSReset line and the fault
+inputs.  The gate outputs are measured cycle by cycle, in clk cycles, sampling
+on the falling edge of clk.  A cycle starts when aux rises.
+
+Covered: register writes in one frame, gate edge timing and overlap, switching
+period (local and global), chip select to applied latency, the PWM dither, the
+readback, fault to shutdown latency and recovery, and the current limiter.
+The measured timings are printed as "bench" lines.  Prints PASS, or FAIL with
+a count; see the makefile.
+*/
+
+/* Copyright (C) agent, 2026 */ 
+
+/* 
+ * This file is part of the UNSWMPPTNG firmware.
+ * 
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ 
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ 
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+`timescale 1 ns / 100 ps
+
+module tb_top;
+
+	// Register values, as the firmware's defaults
+	parameter PERIOD = 1300;
+	parameter AUX_LENGTH = 55;
+	parameter AUX_OVERLAP = 8;
+	parameter DEADTIME = 25;
+
+	parameter SPI_HALF = 271;	// ns, half a bit at 1.84MHz
+
+	reg clk;
+	reg serialin, mspclk, nchpsel;
+	reg FSReset, nFPGAReset, FPGAEnable, nMSPReset;
+	reg nVoltFault, nReg15Fault, nReg5Fault, nCurrentFault;
+	wire serialout, LED1, LED2, nSD, aux, main, diode, SD;
+
+	NgControlCpld dut (.clk(clk), .ste(1'b0), .serialin(serialin), .serialout(serialout),
+					   .mspclk(mspclk), .nchpsel(nchpsel), .gpio1(1'b0), .gpio2(1'b0),
+					   .LED1(LED1), .LED2(LED2), .nSD(nSD), .FSReset(FSReset),
+					   .nFPGAReset(nFPGAReset), .FPGAEnable(FPGAEnable), .nMSPReset(nMSPReset),
+					   .nVoltFault(nVoltFault), .nReg15Fault(nReg15Fault), .nReg5Fault(nReg5Fault),
+					   .nCurrentFault(nCurrentFault), .aux(aux), .main(main), .diode(diode), .SD(SD));
+
+	// 40MHz, rising edges at 12.5ns + n * 25ns, so they never line up with the
+	// SPI edges, which are on whole ns
+	initial clk = 1'b0;
+	always #12.5 clk = ~clk;
+
+	// An edge that never comes would leave vvp running for good; the run takes
+	// well under this
+	initial begin
+		#10000000;
+		$display("FAIL tb_top: timeout");
+		$finish;
+	end
+
+	integer errors;
+
+	task check;
+		input ok;
+		input [8*48-1:0] what;
+		input integer got;
+		input integer want;
+		begin
+			if (ok)
+				$display("  ok    %0s: %0d", what, got);
+			else begin
+				$display("  FAIL  %0s: %0d, expected %0d", what, got, want);
+				errors = errors + 1;
+			end
+		end
+	endtask
+
+	task bench;
+		input [8*48-1:0] what;
+		input integer clks;
+		begin
+			$display("  bench %0s: %0d clk", what, clks);
+		end
+	endtask
+
+	//-------------------------------------------------------------------
+	// Cycle monitor: at every rising edge of aux, the figures for the cycle
+	// just finished are copied to last_x and cycle_done fires
+
+	event cycle_done;
+	integer cycles_seen;
+	integer cnt, aux_c, main_c, ovl_c, diode_c, main_at;
+	integer last_period, last_aux, last_main, last_ovl, last_diode, last_main_at;
+	reg prev_aux;
+
+	initial begin
+		cycles_seen = 0;
+		prev_aux = 1'b0;
+		cnt = 0; aux_c = 0; main_c = 0; ovl_c = 0; diode_c = 0; main_at = -1;
+	end
+
+	always @(negedge clk) begin
+		if (aux && !prev_aux) begin
+			last_period = cnt; last_aux = aux_c; last_main = main_c;
+			last_ovl = ovl_c; last_diode = diode_c; last_main_at = main_at;
+			cnt = 0; aux_c = 0; main_c = 0; ovl_c = 0; diode_c = 0; main_at = -1;
+			cycles_seen = cycles_seen + 1;
+			-> cycle_done;
+		end
+		cnt = cnt + 1;
+		if (aux) aux_c = aux_c + 1;
+		if (main) main_c = main_c + 1;
+		if (aux && main) ovl_c = ovl_c + 1;
+		if (diode) diode_c = diode_c + 1;
+		if (main && main_at < 0) main_at = cnt - 1;
+		prev_aux = aux;
+	end
+
+	// Count the limited cycles (pulses cut short by the current limiter)
+	integer limited_cycles;
+	initial limited_cycles = 0;
+	always @(posedge dut.board.limiting)
+		limited_cycles = limited_cycles + 1;
+
+	task skip_cycles;
+		input integer n;
+		begin
+			repeat (n) @(cycle_done);
+		end
+	endtask
+
+	//-------------------------------------------------------------------
+	// SPI, as the MSP430 master: words in tx[], what came back in rx[]
+
+	reg [15:0] tx [0:7];
+	reg [7:0] rx [0:15];
+	integer cs_fall_cycles;		// cycles_seen when chip select last went low
+
+	function [15:0] spi_word;
+		input [1:0] board;
+		input [2:0] signal;
+		input [10:0] value;
+		spi_word = {board, signal, value};
+	endfunction
+
+	// Returns as soon as chip select goes high, so that the caller can time what
+	// follows; the gap the CPLD needs between frames is left before the next one
+	task spi_frame;
+		input integer words;
+		integer w, b, i;
+		begin
+			#500;
+			for (i = 0; i < 16; i = i + 1)
+				rx[i] = 8'b0;
+			nchpsel = 1'b0;
+			cs_fall_cycles = cycles_seen;
+			#200;
+			for (w = 0; w < words; w = w + 1)
+				for (b = 15; b >= 0; b = b - 1) begin
+					serialin = tx[w][b];
+					#SPI_HALF mspclk = 1'b1;
+					i = (w * 16 + 15 - b) / 8;
+					rx[i] = {rx[i][6:0], serialout};
+					#SPI_HALF mspclk = 1'b0;
+				end
+			#100 nchpsel = 1'b1;
+		end
+	endtask
+
+	// Rewrite registers 1 to 4 with their current values to get the whole readback
+	reg [10:0] cur_main, cur_frac;
+
+	task readback;
+		begin
+			tx[0] = spi_word(2'd1, 3'd1, AUX_LENGTH);
+			tx[1] = AUX_OVERLAP;
+			tx[2] = cur_main;
+			tx[3] = cur_frac;
+			spi_frame(4);
+		end
+	endtask
+
+	task set_pwm;
+		input [10:0] length;
+		input [10:0] frac;
+		begin
+			cur_main = length;
+			cur_frac = frac;
+			tx[0] = spi_word(2'd1, 3'd3, length);
+			tx[1] = frac;
+			spi_frame(2);
+		end
+	endtask
+
+	task fs_reset;
+		begin
+			@(negedge clk);
+			FSReset = 1'b1;
+			repeat (10) @(negedge clk);
+			FSReset = 1'b0;
+			repeat (10) @(negedge clk);
+		end
+	endtask
+
+	//-------------------------------------------------------------------
+
+	integer n, i, sum, c1, c2, s1, s2;
+
+	initial begin
+		errors = 0;
+		serialin = 1'b0; mspclk = 1'b0; nchpsel = 1'b1;
+		FSReset = 1'b0; nFPGAReset = 1'b1; FPGAEnable = 1'b1; nMSPReset = 1'b1;
+		nVoltFault = 1'b1; nReg15Fault = 1'b1; nReg5Fault = 1'b1; nCurrentFault = 1'b1;
+		cur_main = 400; cur_frac = 0;
+
+		repeat (10) @(negedge clk);
+		check(SD == 1'b1, "power up: SD", SD, 1);
+
+		// As fpga_init(): every register in one frame, then FSReset
+		$display("registers, one frame");
+		tx[0] = spi_word(2'd1, 3'd0, PERIOD);
+		tx[1] = AUX_LENGTH;
+		tx[2] = AUX_OVERLAP;
+		tx[3] = cur_main;
+		tx[4] = cur_frac;
+		tx[5] = DEADTIME;
+		spi_frame(6);
+		fs_reset;
+		check(SD == 1'b0 && nSD == 1'b1, "after FSReset: SD", SD, 0);
+
+		skip_cycles(3);
+		check(last_period == PERIOD + 5, "switching period", last_period, PERIOD + 5);
+		check(last_aux == AUX_LENGTH - 1, "aux width", last_aux, AUX_LENGTH - 1);
+		check(last_main == cur_main - 1, "main width", last_main, cur_main - 1);
+		check(last_main_at == AUX_LENGTH - AUX_OVERLAP, "aux rise to main rise", last_main_at,
+			  AUX_LENGTH - AUX_OVERLAP);
+		check(last_ovl == AUX_OVERLAP - 1, "aux/main overlap", last_ovl, AUX_OVERLAP - 1);
+		// The diode gate is disabled in board.v for now
+		check(last_diode == 0, "diode on", last_diode, 0);
+		bench("period", last_period);
+		bench("aux on", last_aux);
+		bench("aux rise to main rise", last_main_at);
+		bench("main on", last_main);
+		bench("aux/main overlap", last_ovl);
+		bench("main fall to next aux rise", last_period - last_main_at - last_main);
+
+		$display("chip select to applied");
+		tx[0] = spi_word(2'd1, 3'd3, 600);
+		cur_main = 600;
+		spi_frame(1);
+		n = 0;
+		while (!dut.board.signal_load) begin
+			@(posedge clk);
+			#1 n = n + 1;
+		end
+		check(n == 5, "chip select high to signal load", n, 5);
+		bench("chip select high to new on/off points", n + 1);
+		skip_cycles(2);
+		check(last_main == 599, "main width after the write", last_main, 599);
+
+		$display("dither");
+		for (i = 1; i < 16; i = i + 7) begin
+			set_pwm(600, i);
+			skip_cycles(2);
+			sum = 0;
+			for (n = 0; n < 16; n = n + 1) begin
+				@(cycle_done);
+				sum = sum + last_main;
+			end
+			check(sum == 16 * 599 + i, "main over 16 cycles, 600 + i/16", sum, 16 * 599 + i);
+		end
+		set_pwm(600, 0);
+		skip_cycles(2);
+
+		$display("readback");
+		readback;
+		check(rx[0] == 8'h00, "causes", rx[0], 0);
+		check(rx[1] == 8'h00, "live", rx[1], 0);
+		check({rx[2], rx[3]} == 600, "main length", {rx[2], rx[3]}, 600);
+		check({rx[4], rx[5]} == PERIOD, "period", {rx[4], rx[5]}, PERIOD);
+		c1 = {rx[6], rx[7]};
+		s1 = cs_fall_cycles;
+		skip_cycles(10);
+		readback;
+		c2 = {rx[6], rx[7]};
+		s2 = cs_fall_cycles;
+		n = (c2 - c1) & 16'hFFFF;
+		check(n >= s2 - s1 - 1 && n <= s2 - s1 + 1, "switching cycles counted", n, s2 - s1);
+
+		$display("fault");
+		@(posedge main);
+		repeat (10) @(negedge clk);
+		nVoltFault = 1'b0;
+		#1;
+		check(SD == 1'b1 && main == 1'b0 && nSD == 1'b0, "nVoltFault to shutdown, same clk: SD", SD, 1);
+		bench("fault to shutdown (combinational)", 0);
+		repeat (20) @(negedge clk);
+		nVoltFault = 1'b1;
+		repeat (20) @(negedge clk);
+		check(SD == 1'b1, "fault gone, before FSReset: SD", SD, 1);
+		readback;
+		check(rx[0] == 8'h01, "causes", rx[0], 1);
+		check(rx[1] == 8'h80, "live", rx[1], 8'h80);
+		fs_reset;
+		check(SD == 1'b0, "after FSReset: SD", SD, 0);
+		readback;
+		check(rx[0] == 8'h00, "causes after FSReset", rx[0], 0);
+		skip_cycles(3);
+		check(last_main == 599, "main width after restart", last_main, 599);
+
+		$display("current limit");
+		@(posedge main);
+		repeat (20) @(negedge clk);
+		nCurrentFault = 1'b0;
+		n = 0;
+		while (main) begin
+			@(posedge clk);
+			#1 n = n + 1;
+		end
+		@(negedge clk);
+		nCurrentFault = 1'b1;
+		check(n == 3, "nCurrentFault to main off", n, 3);
+		bench("current limit to main off", n);
+		@(cycle_done);
+		check(last_main == 22, "cut short main width", last_main, 22);
+		@(cycle_done);
+		check(last_main == 599 && SD == 1'b0, "next cycle: main width", last_main, 599);
+
+		// Held down, the board shuts down after 4 cycles in a row
+		n = limited_cycles;
+		nCurrentFault = 1'b0;
+		i = 0;
+		while (!SD && i < 10 * (PERIOD + 5)) begin
+			@(posedge clk);
+			#1 i = i + 1;
+		end
+		check(limited_cycles - n == 4, "cut short cycles before shutdown", limited_cycles - n, 4);
+		check(SD == 1'b1, "held limit: SD", SD, 1);
+		nCurrentFault = 1'b1;
+		repeat (20) @(negedge clk);
+		check(SD == 1'b1, "limit gone, before FSReset: SD", SD, 1);
+		readback;
+		check(rx[0] == 8'h48, "causes", rx[0], 8'h48);
+		fs_reset;
+		check(SD == 1'b0, "after FSReset: SD", SD, 0);
+		readback;
+		check(rx[0] == 8'h00, "causes after FSReset", rx[0], 0);
+		skip_cycles(3);
+		check(last_main == 599, "main width after restart", last_main, 599);
+
+		$display("global period");
+		tx[0] = spi_word(2'd0, 3'd0, 1000);
+		spi_frame(1);
+		skip_cycles(3);
+		check(last_period == 1005, "switching period", last_period, 1005);
+
+		if (errors == 0)
+			$display("PASS tb_top");
+		else
+			$display("FAIL tb_top: %0d errors", errors);
+		$finish;
+	end
+
+endmodule
@@ -0,0 +1,226 @@
+/********************************************
+* tb_units.v								*
+*											*
+* Requisites								*
+*	altera_models.v							*
+*	lpf.v, slpf.v, counter.v, signal.v		*
+*	and the megafunction files they use		*
+*											*
+*********************************************
+Self checking testbench for the small modules under the board: the two glitch
+filters, the ring counter and one signal generator.  Everything is measured
+in clk cycles, sampling on the falling edge of clk (nothing in the design
+changes there).  Prints PASS, or FAIL with a count; see the makefile.
+*/
+
+/* Copyright (C) agent, 2026 */ 
+
+/* 
+ * This file is part of the UNSWMPPTNG firmware.
+ * 
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ 
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ 
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+`timescale 1 ns / 100 ps
+
+module tb_units;
+
+	reg clk;
+	reg fin;					// filter input
+	wire lout, sout;			// lpf and slpf outputs
+
+	reg [10:0] period;
+	reg reset, enable;
+	wire [10:0] counter;
+	wire restart;
+
+	reg [10:0] setpoint, resetpoint;
+	reg load;
+	wire gate;
+
+	integer errors;
+	integer n, first, width;
+
+	lpf LPF (.clk(clk), .in(fin), .out(lout));
+	slpf SLPF (.clk(clk), .in(fin), .out(sout));
+	counter COUNT (.clk(clk), .counter(counter[10:0]), .period(period[10:0]), .reset(reset),
+				   .enable(enable), .sync(1'b0), .follow(1'b0), .restart(restart));
+	signal SIG (.Gate(gate), .clk(clk), .setpoint(setpoint[10:0]), .resetpoint(resetpoint[10:0]),
+				.enable(enable), .load(load), .counter(counter[10:0]));
+
+	// 40MHz, rising edges at 12.5ns + n * 25ns
+	initial clk = 1'b0;
+	always #12.5 clk = ~clk;
+
+	// An edge that never comes would leave vvp running for good; the run takes
+	// well under this
+	initial begin
+		#1000000;
+		$display("FAIL tb_units: timeout");
+		$finish;
+	end
+
+	task check;
+		input ok;
+		input [8*48-1:0] what;
+		input integer got;
+		input integer want;
+		begin
+			if (ok)
+				$display("  ok    %0s: %0d", what, got);
+			else begin
+				$display("  FAIL  %0s: %0d, expected %0d", what, got, want);
+				errors = errors + 1;
+			end
+		end
+	endtask
+
+	// Drive the filter input high for len cycles, then measure how long after the
+	// input went high each output came up, and for how long
+	task filter_pulse;
+		input integer len;
+		output integer ldelay, lwidth, sdelay, swidth;
+		begin
+			@(negedge clk);
+			fin = 1'b1;
+			ldelay = -1; lwidth = 0; sdelay = -1; swidth = 0;
+			for (n = 0; n < len + 8; n = n + 1) begin
+				@(negedge clk);
+				if (n == len - 1)
+					fin = 1'b0;
+				if (lout) begin
+					if (ldelay < 0) ldelay = n + 1;
+					lwidth = lwidth + 1;
+				end
+				if (sout) begin
+					if (sdelay < 0) sdelay = n + 1;
+					swidth = swidth + 1;
+				end
+			end
+		end
+	endtask
+
+	// Width of the gate over one whole counter period, from one rising edge of restart
+	// to the next, and the counter value it rose on
+	task gate_cycle;
+		output integer high;
+		output integer rise;
+		reg was, done;
+		begin
+			@(posedge restart);
+			high = 0; rise = -1; was = 1'b1; done = 1'b0;
+			while (!done) begin
+				@(negedge clk);
+				if (restart && !was)
+					done = 1'b1;
+				else if (gate) begin
+					if (rise < 0) rise = counter;
+					high = high + 1;
+				end
+				was = restart;
+			end
+		end
+	endtask
+
+	integer ld, lw, sd, sw;
+	integer p0, p1, spacing;
+
+	initial begin
+		errors = 0;
+		fin = 1'b0;
+		period = 11'd20;
+		reset = 1'b1;
+		enable = 1'b0;
+		setpoint = 11'd5;
+		resetpoint = 11'd10;
+		load = 1'b0;
+
+		repeat (5) @(negedge clk);
+
+		$display("lpf / slpf");
+		filter_pulse(1, ld, lw, sd, sw);
+		check(lw == 0, "lpf, 1 cycle glitch: cycles out", lw, 0);
+		check(sw == 0, "slpf, 1 cycle glitch: cycles out", sw, 0);
+		filter_pulse(2, ld, lw, sd, sw);
+		check(lw == 2, "lpf, 2 cycle pulse: cycles out", lw, 2);
+		check(sw == 0, "slpf, 2 cycle pulse: cycles out", sw, 0);
+		filter_pulse(10, ld, lw, sd, sw);
+		check(ld == 2, "lpf delay", ld, 2);
+		check(lw == 10, "lpf, 10 cycle pulse: cycles out", lw, 10);
+		check(sd == 3, "slpf delay", sd, 3);
+		check(sw == 8, "slpf, 10 cycle pulse: cycles out", sw, 8);
+
+		$display("counter");
+		@(negedge clk);
+		reset = 1'b0;
+		enable = 1'b1;
+		@(negedge clk);
+		load = 1'b1;
+		@(negedge clk);
+		load = 1'b0;
+		// restart is filtered by slpf, so the counter runs to period + 3 and then sits
+		// at zero for two cycles
+		@(posedge restart);
+		p0 = $time;
+		@(posedge restart);
+		p1 = $time;
+		spacing = (p1 - p0) / 25;
+		check(spacing == period + 5, "cycle length, period 20", spacing, period + 5);
+		period = 11'd100;
+		@(posedge restart);
+		@(posedge restart);
+		p0 = $time;
+		@(posedge restart);
+		p1 = $time;
+		spacing = (p1 - p0) / 25;
+		check(spacing == period + 5, "cycle length, period 100", spacing, period + 5);
+
+		$display("signal");
+		// on while setpoint < counter < resetpoint, two cycles late through lpf
+		setpoint = 11'd20;
+		resetpoint = 11'd50;
+		@(negedge clk);
+		load = 1'b1;
+		@(negedge clk);
+		load = 1'b0;
+		gate_cycle(width, first);
+		check(width == 29, "set 20, reset 50: width", width, 29);
+		check(first == 23, "set 20, reset 50: counter at rise", first, 23);
+		// setpoint after resetpoint: on across the counter restart
+		setpoint = 11'd80;
+		resetpoint = 11'd10;
+		@(negedge clk);
+		load = 1'b1;
+		@(negedge clk);
+		load = 1'b0;
+		gate_cycle(width, first);
+		check(width == 105 - 71, "set 80, reset 10: width", width, 105 - 71);
+		// the setpoint isn't used until load
+		setpoint = 11'd20;
+		resetpoint = 11'd50;
+		gate_cycle(width, first);
+		check(width == 105 - 71, "no load: width unchanged", width, 105 - 71);
+		// and enable low holds the output off
+		enable = 1'b0;
+		@(negedge clk);
+		check(gate == 1'b0, "enable low: gate", gate, 0);
+
+		if (errors == 0)
+			$display("PASS tb_units");
+		else
+			$display("FAIL tb_units: %0d errors", errors);
+		$finish;
+	end
+
+endmodule
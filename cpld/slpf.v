@@ -56,9 +56,9 @@ module slpf (
 	wire	ubuff23;
 
 	//The low pass filter: if any of the bits are low, the output is low
-	DFF (.D(in), .CLK(clk), .Q(ubuff1)); 
-	DFF (.D(ubuff1), .CLK(clk), .Q(ubuff2)); 
-	DFF (.D(ubuff2), .CLK(clk), .Q(ubuff3));
+	DFF DBUF1 (.D(in), .CLK(clk), .Q(ubuff1)); 
+	DFF DBUF2 (.D(ubuff1), .CLK(clk), .Q(ubuff2)); 
+	DFF DBUF3 (.D(ubuff2), .CLK(clk), .Q(ubuff3));
 
 	and prod (out, ubuff1, ubuff2, ubuff3);		
 
@@ -0,0 +1,10 @@
+/* Host build shim for the scandal msp430f149 <arch/adc.h> header */ 
+#ifndef __HOST_ARCH_ADC__
+#define __HOST_ARCH_ADC__
+
+#include <io.h>
+
+#define ADC_INTERRUPT_ENABLE()   (ADC12IE |= (1 << 5))
+#define ADC_INTERRUPT_DISABLE()  (ADC12IE &= ~(1 << 5))
+
+#endif
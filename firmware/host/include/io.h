@@ -0,0 +1,175 @@
+/* Host build shim for the mspgcc <io.h> header. 
+   Every peripheral register used by the firmware is backed by an 
+   ordinary variable in msp430_shim.c, so that the firmware sources 
+   can be compiled and run unmodified against the plant model. */ 
+
+/* Copyright (C) agent, 2026 */ 
+
+/* 
+ * This file is part of the UNSWMPPTNG firmware.
+ * 
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ 
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ 
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __HOST_IO__
+#define __HOST_IO__
+
+#include <stdint.h>
+
+#define HOST_REG8(name)  extern volatile uint8_t name
+#define HOST_REG16(name) extern volatile uint16_t name
+
+/* Digital I/O */ 
+HOST_REG8(P1IN); HOST_REG8(P1OUT); HOST_REG8(P1DIR); HOST_REG8(P1SEL); 
+HOST_REG8(P1IE); HOST_REG8(P1IES); HOST_REG8(P1IFG); 
+HOST_REG8(P2IN); HOST_REG8(P2OUT); HOST_REG8(P2DIR); HOST_REG8(P2SEL); 
+HOST_REG8(P2IE); HOST_REG8(P2IES); HOST_REG8(P2IFG); 
+HOST_REG8(P3IN); HOST_REG8(P3OUT); HOST_REG8(P3DIR); HOST_REG8(P3SEL); 
+HOST_REG8(P4IN); HOST_REG8(P4OUT); HOST_REG8(P4DIR); HOST_REG8(P4SEL); 
+HOST_REG8(P5IN); HOST_REG8(P5OUT); HOST_REG8(P5DIR); HOST_REG8(P5SEL); 
+HOST_REG8(P6IN); HOST_REG8(P6OUT); HOST_REG8(P6DIR); HOST_REG8(P6SEL); 
+
+/* Special function / clock / watchdog */ 
+HOST_REG8(IE1); HOST_REG8(ME1); 
+HOST_REG8(BCSCTL1); HOST_REG8(BCSCTL2); HOST_REG8(DCOCTL);
+HOST_REG16(WDTCTL); 
+
+/* IFG1 is read through a function so that busy-waits on the USART 
+   flags complete immediately: any byte waiting in TXBUF0 is clocked 
+   out to the CPLD model first */ 
+extern volatile uint8_t* host_ifg1(void); 
+#define IFG1 (*host_ifg1())
+
+/* USART0 in SPI mode */ 
+HOST_REG8(U0CTL); HOST_REG8(U0TCTL); HOST_REG8(U0RCTL); 
+HOST_REG8(UBR00); HOST_REG8(UBR10); HOST_REG8(UMCTL0); 
+/* The firmware only ever writes TXBUF0, so every access is taken 
+   as a new byte for the transmitter */ 
+extern volatile uint8_t* host_txbuf0(void); 
+#define TXBUF0 (*host_txbuf0())
+extern uint8_t host_spi0_rxbuf(void); 
+#define RXBUF0 (host_spi0_rxbuf())
+
+/* Timer B */ 
+HOST_REG16(TBCTL); HOST_REG16(TBCCTL0); HOST_REG16(TBCCR0); HOST_REG16(TBR); 
+
+/* Timer A */ 
+HOST_REG16(TACTL); HOST_REG16(TACCTL0); HOST_REG16(TACCR0); HOST_REG16(TAR); 
+
+/* ADC12 */ 
+HOST_REG16(ADC12CTL0); HOST_REG16(ADC12CTL1); 
+HOST_REG16(ADC12IFG); HOST_REG16(ADC12IE); HOST_REG16(ADC12IV); 
+HOST_REG8(ADC12MCTL0); HOST_REG8(ADC12MCTL1); HOST_REG8(ADC12MCTL2); 
+HOST_REG8(ADC12MCTL3); HOST_REG8(ADC12MCTL4); HOST_REG8(ADC12MCTL5); 
+HOST_REG16(ADC12MEM0); HOST_REG16(ADC12MEM1); HOST_REG16(ADC12MEM2); 
+HOST_REG16(ADC12MEM3); HOST_REG16(ADC12MEM4); HOST_REG16(ADC12MEM5); 
+
+/* Status register / global interrupt enable */ 
+extern volatile int host_gie; 
+#define dint()      (host_gie = 0)
+#define eint()      (host_gie = 1)
+#define READ_SR     (host_gie ? GIE : 0)
+#define _BIC_SR(x)  ((x) & GIE ? (void)(host_gie = 0) : (void)0)
+#define _BIS_SR(x)  ((x) & GIE ? (void)(host_gie = 1) : (void)0)
+#define GIE         0x0008
+#define OSCOFF      0x0020
+
+/* Interrupt vectors (only used as tokens by the interrupt() macro) */ 
+#define PORT2_VECTOR    2
+#define USART1TX_VECTOR 4
+#define USART1RX_VECTOR 6
+#define PORT1_VECTOR    8
+#define TIMERA1_VECTOR  10
+#define TIMERA0_VECTOR  12
+#define ADC_VECTOR      14
+#define USART0TX_VECTOR 16
+#define USART0RX_VECTOR 18
+#define WDT_VECTOR      20
+#define COMPARATORA_VECTOR 22
+#define TIMERB1_VECTOR  24
+#define TIMERB0_VECTOR  26
+#define NMI_VECTOR      28
+
+/* IFG1 / ME1 */ 
+#define WDTIFG          0x01
+#define OFIFG           0x02
+#define URXIFG0         0x40
+#define UTXIFG0         0x80
+#define USPIE0          0x40
+#define URXIE0          0x40
+#define UTXIE0          0x80
+
+/* Watchdog */ 
+#define WDTPW           0x5A00
+#define WDTHOLD         0x0080
+#define WDTCNTCL        0x0008
+#define WDTSSEL         0x0004
+#define WDT_ARST_1000   (WDTPW | WDTCNTCL | WDTSSEL)
+
+/* USART control */ 
+#define CHAR            0x10
+#define SYNC            0x04
+#define MM              0x02
+#define SWRST           0x01
+#define CKPH            0x80
+#define CKPL            0x40
+#define SSEL1           0x20
+#define SSEL0           0x10
+#define STC             0x02
+#define TXEPT           0x01
+
+/* Timer B */ 
+#define TBSSEL_ACLK     0x0100
+#define TBSSEL_SMCLK    0x0200
+#define ID_DIV1         0x0000
+#define ID_DIV8         0x00C0
+#define MC_STOP         0x0000
+#define MC_UPTO_CCR0    0x0010
+#define MC_CONT         0x0020
+#define TBCLR           0x0004
+#define TBIE            0x0002
+#define CCIE            0x0010
+
+/* ADC12 */ 
+#define ADC12SC         0x0001
+#define ENC             0x0002
+#define ADC12ON         0x0010
+#define REFON           0x0020
+#define REF2_5V         0x0040
+#define MSC             0x0080
+#define SHT0_9          0x0900
+#define SHT1_9          0x9000
+
+#define ADC12BUSY       0x0001
+#define CONSEQ_3        0x0006
+#define ADC12SSEL_3     0x0018
+#define SHP             0x0200
+#define CSTARTADD_0     0x0000
+
+#define SREF_1          0x10
+#define EOS             0x80
+#define INCH_0          0
+#define INCH_1          1
+#define INCH_2          2
+#define INCH_3          3
+#define INCH_4          4
+#define INCH_5          5
+#define INCH_6          6
+#define INCH_7          7
+#define INCH_8          8
+#define INCH_9          9
+#define INCH_10         10
+#define INCH_11         11
+
+#endif
@@ -0,0 +1,2 @@
+/* Host build shim -- see io.h */ 
+#include <io.h>
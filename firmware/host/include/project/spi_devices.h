@@ -0,0 +1,30 @@
+/* Host build shim for <project/spi_devices.h>. 
+   The chip selects are routed to the plant model so that it can 
+   frame SPI transfers to the CPLD the same way inblock.v does. */ 
+
+#ifndef __SPIDEVICES__ 
+#define __SPIDEVICES__ 
+
+#include <io.h>
+
+#define BIT(x) (1<<x)
+
+#define MCP2510			0              
+#define SPI_NUM_DEVICES         1
+#define SPI_DEVICE_NONE		SPI_NUM_DEVICES 
+
+#define FPGA                    0
+#define SPI0_NUM_DEVICES        1
+#define SPI0_DEVICE_NONE        SPI0_NUM_DEVICES
+
+extern void host_fpga_select(int selected); 
+
+/* MCP2510 */
+#define ENABLE_MCP2510()        (P5OUT &= ~BIT(0))
+#define DISABLE_MCP2510()       (P5OUT |= BIT(0))
+
+/* FPGA */
+#define ENABLE_FPGA_SPI()           host_fpga_select(1)
+#define DISABLE_FPGA_SPI()          host_fpga_select(0)
+
+#endif
@@ -0,0 +1,10 @@
+/* Host build shim -- see scandal/types.h */ 
+#ifndef __HOST_SCANDAL_ADC__
+#define __HOST_SCANDAL_ADC__
+
+#include <scandal/types.h>
+
+void init_adc(void); 
+u16  sample_adc(u08 channel); 
+
+#endif
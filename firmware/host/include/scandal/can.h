@@ -0,0 +1,10 @@
+/* Host build shim -- see scandal/types.h */ 
+#ifndef __HOST_SCANDAL_CAN__
+#define __HOST_SCANDAL_CAN__
+
+#include <scandal/types.h>
+
+void can_interrupt(void); 
+u08  can_send_msg(can_msg* msg, u08 priority); 
+
+#endif
@@ -0,0 +1,55 @@
+/* Host build shim for <scandal/devices.h>. 
+   Channel, parameter, command and error numbers for the UNSWMPPTNG. 
+   Only the relative identity of these numbers matters to the host 
+   build. */ 
+
+#ifndef __HOST_SCANDAL_DEVICES__
+#define __HOST_SCANDAL_DEVICES__
+
+#define UNSWMPPTNG                        30
+
+/* Out channels */ 
+#define UNSWMPPTNG_IN_VOLTAGE             0
+#define UNSWMPPTNG_IN_CURRENT             1
+#define UNSWMPPTNG_OUT_VOLTAGE            2
+#define UNSWMPPTNG_15V                    3
+#define UNSWMPPTNG_HEATSINK_TEMP          4
+#define UNSWMPPTNG_AMBIENT_TEMP           5
+#define UNSWMPPTNG_STATUS                 6
+#define UNSWMPPTNG_PANDO_POWER            7
+#define UNSWMPPTNG_SWEEP_IN_VOLTAGE       8
+#define UNSWMPPTNG_SWEEP_IN_CURRENT       9
+#define UNSWMPPTNG_NUM_OUT_CHANNELS       10
+
+/* In channels */ 
+#define UNSWMPPTNG_NUM_IN_CHANNELS        0
+
+/* Configuration parameters */ 
+#define UNSWMPPTNG_MAX_VOUT               0
+#define UNSWMPPTNG_MIN_VIN                1
+#define UNSWMPPTNG_ALGORITHM              2
+#define UNSWMPPTNG_IN_KP                  3
+#define UNSWMPPTNG_IN_KI                  4
+#define UNSWMPPTNG_IN_KD                  5
+#define UNSWMPPTNG_OUT_KP                 6
+#define UNSWMPPTNG_OUT_KI                 7
+#define UNSWMPPTNG_OUT_KD                 8
+#define UNSWMPPTNG_OPENLOOP_RATIO         9
+#define UNSWMPPTNG_OPENLOOP_RETRACK_PERIOD 10
+#define UNSWMPPTNG_PANDO_INCREMENT        11
+#define UNSWMPPTNG_IVSWEEP_SAMPLE_PERIOD  12
+#define UNSWMPPTNG_IVSWEEP_STEP_SIZE      13
+
+/* Commands */ 
+#define UNSWMPPTNG_COMMAND_IVSWEEP        0
+#define UNSWMPPTNG_COMMAND_SET_TARGET     1
+#define UNSWMPPTNG_COMMAND_SET_AND_TUNE   2
+
+/* Errors */ 
+#define UNSWMPPTNG_ERROR_EEPROM               8
+#define UNSWMPPTNG_ERROR_WATCHDOG_RESET       9
+#define UNSWMPPTNG_ERROR_OUTPUT_OVER_VOLTAGE  10
+#define UNSWMPPTNG_ERROR_INPUT_UNDER_VOLTAGE  11
+#define UNSWMPPTNG_ERROR_FPGA_SHUTDOWN        12
+
+#endif
@@ -0,0 +1,10 @@
+/* Host build shim -- see scandal/types.h */ 
+#ifndef __HOST_SCANDAL_EEPROM__
+#define __HOST_SCANDAL_EEPROM__
+
+#include <scandal/types.h>
+
+u08 sc_user_eeprom_read_block(u32 loc, u08* data, u08 length); 
+u08 sc_user_eeprom_write_block(u32 loc, u08* data, u08 length); 
+
+#endif
@@ -0,0 +1,22 @@
+/* Host build shim -- see scandal/types.h */ 
+#ifndef __HOST_SCANDAL_ENGINE__
+#define __HOST_SCANDAL_ENGINE__
+
+#include <scandal/types.h>
+#include <scandal/devices.h>
+#include <scandal/timer.h>
+
+void scandal_init(void); 
+void handle_scandal(void); 
+u08  scandal_get_addr(void); 
+
+u08  scandal_send_channel(u08 priority, u16 channel_num, s32 value); 
+u08  scandal_send_scaled_channel(u08 priority, u16 channel_num, s32 value); 
+u08  scandal_get_scaled_value(u16 chan_num, s32* value); 
+u08  scandal_get_unscaled_value(u16 chan_num, s32* value); 
+void scandal_set_m(u16 chan_num, s32 m); 
+void scandal_set_b(u16 chan_num, s32 b); 
+s32  scandal_get_m(u16 chan_num); 
+s32  scandal_get_b(u16 chan_num); 
+
+#endif
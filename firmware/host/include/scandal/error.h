@@ -0,0 +1,11 @@
+/* Host build shim -- see scandal/types.h */ 
+#ifndef __HOST_SCANDAL_ERROR__
+#define __HOST_SCANDAL_ERROR__
+
+#include <scandal/types.h>
+
+#define NO_ERR  0
+
+void scandal_do_user_err(u08 err); 
+
+#endif
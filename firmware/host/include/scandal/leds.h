@@ -0,0 +1,12 @@
+/* Host build shim -- see scandal/types.h */ 
+#ifndef __HOST_SCANDAL_LEDS__
+#define __HOST_SCANDAL_LEDS__
+
+#include <scandal/types.h>
+
+void red_led(u08 on); 
+void yellow_led(u08 on); 
+void toggle_red_led(void); 
+void toggle_yellow_led(void); 
+
+#endif
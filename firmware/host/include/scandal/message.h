@@ -0,0 +1,20 @@
+/* Host build shim -- see scandal/types.h */ 
+#ifndef __HOST_SCANDAL_MESSAGE__
+#define __HOST_SCANDAL_MESSAGE__
+
+#include <scandal/engine.h>
+
+#define TELEM_HIGH  5
+#define TELEM_LOW   7
+
+/* Identifier layout: priority, type, source node, channel */ 
+#define PRI_OFFSET          26
+#define TYPE_OFFSET         18
+#define NODE_ADDR_OFFSET    10
+#define CHANNEL_NUM_OFFSET  0
+
+#define CHANNEL_TYPE        0
+
+u32 scandal_mk_channel_id(u08 priority, u08 source, u16 channel_num); 
+
+#endif
@@ -0,0 +1,13 @@
+/* Host build shim -- see scandal/types.h */ 
+#ifndef __HOST_SCANDAL_OBLIGATIONS__
+#define __HOST_SCANDAL_OBLIGATIONS__
+
+#include <scandal/types.h>
+
+void scandal_reset_node(void); 
+void scandal_user_do_first_run(void); 
+u08  scandal_user_do_config(u08 param, s32 value, s32 value2); 
+u08  scandal_user_handle_command(u08 command, u08* data); 
+u08  scandal_user_handle_message(can_msg* msg); 
+
+#endif
@@ -0,0 +1,7 @@
+/* Host build shim -- see scandal/types.h */ 
+#ifndef __HOST_SCANDAL_SPI__
+#define __HOST_SCANDAL_SPI__
+
+#include <scandal/types.h>
+
+#endif
@@ -0,0 +1,10 @@
+/* Host build shim -- see scandal/types.h */ 
+#ifndef __HOST_SCANDAL_TIMER__
+#define __HOST_SCANDAL_TIMER__
+
+#include <scandal/types.h>
+
+void      sc_init_timer(void); 
+sc_time_t sc_get_timer(void); 
+
+#endif
@@ -0,0 +1,27 @@
+/* Host build shim for the scandal headers. Only the parts of the 
+   scandal API used by the MPPTNG firmware are provided; see 
+   host/src/scandal_shim.c for the implementations. */ 
+
+#ifndef __HOST_SCANDAL_TYPES__
+#define __HOST_SCANDAL_TYPES__
+
+#include <stdint.h>
+
+typedef uint8_t   u08; 
+typedef int8_t    s08; 
+typedef uint16_t  u16; 
+typedef int16_t   s16; 
+typedef uint32_t  u32; 
+typedef int32_t   s32; 
+typedef uint64_t  u64; 
+typedef int64_t   s64; 
+
+typedef u32       sc_time_t; 
+
+typedef struct can_msg {
+  u32 id; 
+  u08 data[8]; 
+  u08 length; 
+} can_msg; 
+
+#endif
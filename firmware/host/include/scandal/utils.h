@@ -0,0 +1,7 @@
+/* Host build shim -- see scandal/types.h */ 
+#ifndef __HOST_SCANDAL_UTILS__
+#define __HOST_SCANDAL_UTILS__
+
+#include <scandal/engine.h>
+
+#endif
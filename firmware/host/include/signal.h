@@ -0,0 +1,12 @@
+/* Host build shim for the mspgcc <signal.h> header. 
+   Interrupt handlers become plain functions which the host 
+   simulator calls when the corresponding event fires. */ 
+
+#ifndef __HOST_SIGNAL__
+#define __HOST_SIGNAL__
+
+#include_next <signal.h>
+
+#define interrupt(vector) void
+
+#endif
@@ -0,0 +1,483 @@
+/* Copyright (C) agent, 2026 */
+
+/*
+ * This file is part of the UNSWMPPTNG firmware.
+ *
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Closed-loop benchmark for the MPPTNG firmware.
+
+   Runs the unmodified firmware (mpptng.c main loop, ADC12ISR and the
+   pv_track Timer B interrupt) against the plant model and reports
+   harvested vs. available energy, ISR counts and, for a target step,
+   the settling time of the input loop.
+
+   main() raises UNSWMPPTNG_ERROR_WATCHDOG_RESET on every start, not only
+   after a watchdog reset, so "user errors" is at least 1 (last 9) on a
+   run that is otherwise clean.
+
+   Usage: mpptng_bench [options]
+     -a <algorithm>  openloop, pando, inccond, ivsweep, manual, gmppt,
+                     vspando
+                     or a number
+     -p <profile>    irradiance profile: const, ramp, cloud, shade
+     -g <W/m^2>      irradiance for the const profile (default 1000)
+     -t <s>          simulated run time (default 10)
+     -w <s>          warm-up excluded from the energy figures (default 1)
+     -S <mV>         step the target to this voltage (selects manual)
+     -T <s>          time of the target step (default 2)
+     -n <LSB>        RMS ADC noise (default 1)
+     -P <boards>     interleaved power boards fitted, 1 to 3 (default 1),
+                     also sets num_phases
+     -s <seed>       noise seed
+     -o <file>       write a CSV trace of every ADC sequence
+     -c <p>=<value>  set a configuration parameter through
+                     scandal_user_do_config() before starting
+     -C <s>:<cmd>[:<b0>,<b1>...]
+                     send scandal command <cmd> (a number or a name
+                     below) at time <s>, with optional data bytes
+     -l <file>       write a CSV log of every channel message sent */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include <io.h>
+#include <scandal/devices.h>
+#include <scandal/obligations.h>
+
+#include <project/hardware.h>
+#include <project/mpptng.h>
+#include <project/control.h>
+#include <project/config.h>
+#include <project/fpga.h>
+
+#include "host.h"
+
+#define PROFILE_CONST   0
+#define PROFILE_RAMP    1
+#define PROFILE_CLOUD   2
+#define PROFILE_SHADE   3
+
+#define BENCH_MAX_CONFIG 16
+#define BENCH_MAX_COMMANDS 8
+
+double         host_time;
+double         host_end_time;
+jmp_buf        host_exit;
+host_stats_t   host_stats;
+
+static struct {
+  int    algorithm;
+  int    profile;
+  double irradiance;
+  double warmup;
+  double step_time;
+  int32_t step_mv;
+  FILE*  trace;
+  FILE*  can_log;
+  int    num_config;
+  struct {
+    double time;               /* < 0 to set before starting */
+    int param;
+    int32_t value;
+    int sent;
+  } config[BENCH_MAX_CONFIG];
+  int    num_commands;
+  struct {
+    double time;
+    int command;
+    int sent;
+    u08 data[8];
+  } commands[BENCH_MAX_COMMANDS];
+} bench = {
+  .algorithm  = DEFAULT_ALGORITHM,
+  .profile    = PROFILE_CONST,
+  .irradiance = 1000.0,
+  .warmup     = 1.0,
+  .step_time  = 2.0,
+  .step_mv    = 0,
+  .trace      = NULL,
+  .can_log    = NULL,
+};
+
+/* Results */
+static double energy_at_warmup, energy_mpp_at_warmup;
+static int    warmed_up;
+static int    stepped;
+static double step_from, step_to;
+static double last_outside, peak_excursion;
+
+static const char* algorithm_names[MPPTNG_NUM_ALGORITHMS] = {
+  "openloop", "pando", "inccond", "ivsweep", "manual", "gmppt",
+  "vspando",
+};
+
+static const struct {
+  const char* name;
+  int param;
+} param_names[] = {
+  { "max_vout",            UNSWMPPTNG_MAX_VOUT },
+  { "min_vin",             UNSWMPPTNG_MIN_VIN },
+  { "algorithm",           UNSWMPPTNG_ALGORITHM },
+  { "in_kp",               UNSWMPPTNG_IN_KP },
+  { "in_ki",               UNSWMPPTNG_IN_KI },
+  { "in_kd",               UNSWMPPTNG_IN_KD },
+  { "out_kp",              UNSWMPPTNG_OUT_KP },
+  { "out_ki",              UNSWMPPTNG_OUT_KI },
+  { "out_kd",              UNSWMPPTNG_OUT_KD },
+  { "openloop_ratio",      UNSWMPPTNG_OPENLOOP_RATIO },
+  { "pando_increment",     UNSWMPPTNG_PANDO_INCREMENT },
+  { "gmppt_scan_period",   UNSWMPPTNG_GMPPT_SCAN_PERIOD },
+  { "gmppt_sample_period", UNSWMPPTNG_GMPPT_SAMPLE_PERIOD },
+  { "gmppt_step_size",     UNSWMPPTNG_GMPPT_STEP_SIZE },
+  { "gmppt_local",         UNSWMPPTNG_GMPPT_LOCAL_ALGORITHM },
+  { "pando_update_period", UNSWMPPTNG_PANDO_UPDATE_PERIOD },
+  { "vspando_min_step",    UNSWMPPTNG_VSPANDO_MIN_STEP },
+  { "vspando_max_step",    UNSWMPPTNG_VSPANDO_MAX_STEP },
+  { "vspando_gain",        UNSWMPPTNG_VSPANDO_GAIN },
+  { "ivsweep_step_size",   UNSWMPPTNG_IVSWEEP_STEP_SIZE },
+  { "ivsweep_num_points",  UNSWMPPTNG_IVSWEEP_NUM_POINTS },
+  { "telemetry_mode",      UNSWMPPTNG_TELEMETRY_MODE },
+  { "num_phases",          UNSWMPPTNG_NUM_PHASES },
+  { "phase_current",       UNSWMPPTNG_PHASE_CURRENT },
+  { "gain_band_current",   UNSWMPPTNG_GAIN_BAND_CURRENT },
+  { "in_gain0",            UNSWMPPTNG_IN_GAIN_SCHEDULE + 0 },
+  { "in_gain1",            UNSWMPPTNG_IN_GAIN_SCHEDULE + 1 },
+  { "in_gain2",            UNSWMPPTNG_IN_GAIN_SCHEDULE + 2 },
+  { "in_gain3",            UNSWMPPTNG_IN_GAIN_SCHEDULE + 3 },
+  { "out_gain0",           UNSWMPPTNG_OUT_GAIN_SCHEDULE + 0 },
+  { "out_gain1",           UNSWMPPTNG_OUT_GAIN_SCHEDULE + 1 },
+  { "out_gain2",           UNSWMPPTNG_OUT_GAIN_SCHEDULE + 2 },
+  { "out_gain3",           UNSWMPPTNG_OUT_GAIN_SCHEDULE + 3 },
+  { "feedforward",         UNSWMPPTNG_FEEDFORWARD },
+  { "feedforward_gain",    UNSWMPPTNG_FEEDFORWARD_GAIN },
+};
+
+static const struct {
+  const char* name;
+  int command;
+} command_names[] = {
+  { "ivsweep",             UNSWMPPTNG_COMMAND_IVSWEEP },
+  { "ivsweep_send",        UNSWMPPTNG_COMMAND_IVSWEEP_SEND },
+  { "scope_arm",           UNSWMPPTNG_COMMAND_SCOPE_ARM },
+  { "scope_send",          UNSWMPPTNG_COMMAND_SCOPE_SEND },
+  { "isr_stats",           UNSWMPPTNG_COMMAND_ISR_STATS },
+  { "tune",                UNSWMPPTNG_COMMAND_SET_AND_TUNE },
+};
+
+static void
+parse_command(const char* s){
+  const char* colon = strchr(s, ':');
+  const char* data;
+  size_t len;
+  unsigned k;
+
+  if(colon == NULL || bench.num_commands >= BENCH_MAX_COMMANDS){
+    fprintf(stderr, "bad command '%s'\n", s);
+    exit(1);
+  }
+
+  data = strchr(colon + 1, ':');
+  len = data ? (size_t)(data - (colon + 1)) : strlen(colon + 1);
+
+  bench.commands[bench.num_commands].time = atof(s);
+  bench.commands[bench.num_commands].command = atoi(colon + 1);
+  for(k=0; k<sizeof(command_names)/sizeof(command_names[0]); k++)
+    if(strncmp(colon + 1, command_names[k].name, len) == 0 &&
+       command_names[k].name[len] == '\0')
+      bench.commands[bench.num_commands].command = command_names[k].command;
+
+  for(k=0; data != NULL && k<8; k++){
+    bench.commands[bench.num_commands].data[k] = strtoul(data + 1, NULL, 0);
+    data = strchr(data + 1, ',');
+  }
+  bench.num_commands++;
+}
+
+static void
+parse_config(const char* s){
+  const char* eq = strchr(s, '=');
+  const char* at;
+  unsigned k;
+
+  if(eq == NULL || bench.num_config >= BENCH_MAX_CONFIG){
+    fprintf(stderr, "bad config setting '%s'\n", s);
+    exit(1);
+  }
+
+  at = strchr(eq, '@');
+  bench.config[bench.num_config].time = at ? atof(at + 1) : -1.0;
+  bench.config[bench.num_config].param = atoi(s);
+  for(k=0; k<sizeof(param_names)/sizeof(param_names[0]); k++)
+    if(strncmp(s, param_names[k].name, eq - s) == 0 &&
+       param_names[k].name[eq - s] == '\0')
+      bench.config[bench.num_config].param = param_names[k].param;
+  bench.config[bench.num_config].value = atol(eq + 1);
+  bench.num_config++;
+}
+
+static int
+parse_algorithm(const char* s){
+  int a;
+
+  for(a=0; a<MPPTNG_NUM_ALGORITHMS; a++)
+    if(strcmp(s, algorithm_names[a]) == 0)
+      return a;
+  return atoi(s);
+}
+
+static double
+profile_irradiance(double t){
+  switch(bench.profile){
+  case PROFILE_RAMP:
+    /* 300 W/m^2/s down to 300 W/m^2, hold, then back up */
+    if(t < 2.0)
+      return 1000.0;
+    if(t < 2.0 + 7.0 / 3.0)
+      return 1000.0 - 300.0 * (t - 2.0);
+    if(t < 6.0)
+      return 300.0;
+    if(t < 6.0 + 7.0 / 3.0)
+      return 300.0 + 300.0 * (t - 6.0);
+    return 1000.0;
+
+  case PROFILE_CLOUD:
+    /* Cloud edge: sharp drop, then sharp recovery */
+    if(t >= 2.0 && t < 5.0)
+      return 200.0;
+    return 1000.0;
+
+  case PROFILE_SHADE:
+  case PROFILE_CONST:
+  default:
+    return bench.irradiance;
+  }
+}
+
+/* Partial shading: after 3s the last substring drops to a quarter
+   of the irradiance, which gives a second, larger, peak at a lower
+   voltage than the one the tracker is sitting on */
+static double
+profile_shading(int substring, double t){
+  if(bench.profile == PROFILE_SHADE && t >= 3.0 &&
+     substring == plant_params.substrings - 1)
+    return 0.25;
+  return 1.0;
+}
+
+/* Called at the end of scandal_init(), after the defaults are written */
+void bench_configure(void){
+  int k;
+
+  for(k=0; k<bench.num_config; k++)
+    if(bench.config[k].time < 0)
+      scandal_user_do_config(bench.config[k].param, bench.config[k].value, 0);
+
+  if(bench.step_mv != 0)
+    bench.algorithm = MPPTNG_MANUAL;
+  config.algorithm = bench.algorithm;
+  config_write();
+}
+
+static void
+send_target(int32_t mv){
+  u08 data[4];
+
+  data[0] = (mv >> 24) & 0xFF;
+  data[1] = (mv >> 16) & 0xFF;
+  data[2] = (mv >> 8) & 0xFF;
+  data[3] = mv & 0xFF;
+  scandal_user_handle_command(UNSWMPPTNG_COMMAND_SET_TARGET, data);
+}
+
+void bench_can_frame(int priority, int channel, int32_t value){
+  if(bench.can_log != NULL)
+    fprintf(bench.can_log, "%.6f,%d,%d,%d\n", host_time, priority, channel, value);
+}
+
+void bench_tick(void){
+  double g = profile_irradiance(host_time);
+  int s;
+
+  for(s=0; s<plant_params.substrings; s++)
+    plant.g[s] = g * profile_shading(s, host_time);
+
+  if(!warmed_up && host_time >= bench.warmup){
+    warmed_up = 1;
+    energy_at_warmup = host_stats.energy;
+    energy_mpp_at_warmup = host_stats.energy_mpp;
+  }
+
+  if(bench.step_mv != 0){
+    if(!stepped && host_time >= bench.step_time){
+      stepped = 1;
+      step_from = plant.vc;
+      send_target(bench.step_mv);
+      step_to = host_scale(UNSWMPPTNG_IN_VOLTAGE, control_get_target()) / 1000.0;
+      last_outside = host_time;
+      peak_excursion = 0;
+    }else if(stepped){
+      double band = 0.02 * fabs(step_to - step_from);
+      double excursion = (plant.vc - step_to) * (step_to < step_from ? -1 : 1);
+
+      if(fabs(plant.vc - step_to) > band)
+	last_outside = host_time;
+      if(excursion > peak_excursion)
+	peak_excursion = excursion;
+    }
+  }
+
+  /* Settings made while running, as over CAN */
+  for(s=0; s<bench.num_config; s++){
+    if(bench.config[s].time >= 0 && !bench.config[s].sent &&
+       host_time >= bench.config[s].time){
+      bench.config[s].sent = 1;
+      scandal_user_do_config(bench.config[s].param, bench.config[s].value, 0);
+    }
+  }
+
+  for(s=0; s<bench.num_commands; s++){
+    if(!bench.commands[s].sent && host_time >= bench.commands[s].time){
+      bench.commands[s].sent = 1;
+      scandal_user_handle_command(bench.commands[s].command,
+				  bench.commands[s].data);
+    }
+  }
+
+  if(bench.trace != NULL)
+    fprintf(bench.trace, "%.6f,%.3f,%.4f,%.3f,%.4f,%.3f,%.1f,%d\n",
+	    host_time, plant.vc, plant.ipv, plant.vout, plant.duty,
+	    host_scale(UNSWMPPTNG_IN_VOLTAGE, control_get_target()) / 1000.0,
+	    g, tracker_status);
+}
+
+static void
+report(void){
+  double energy = host_stats.energy - energy_at_warmup;
+  double energy_mpp = host_stats.energy_mpp - energy_mpp_at_warmup;
+
+  printf("algorithm           %s\n", bench.algorithm < MPPTNG_NUM_ALGORITHMS ?
+	 algorithm_names[bench.algorithm] : "?");
+  printf("simulated time      %.3f s (%.3f s warm-up excluded)\n",
+	 host_time, bench.warmup);
+  printf("energy harvested    %.2f J\n", energy);
+  printf("energy at MPP       %.2f J\n", energy_mpp);
+  printf("tracking efficiency %.3f %%\n",
+	 energy_mpp > 0 ? 100.0 * energy / energy_mpp : 0.0);
+  printf("ADC12ISR calls      %u\n", host_stats.adc_isr);
+  printf("Timer B ISR calls   %u\n", host_stats.timerb_isr);
+  printf("PORT1 ISR calls     %u\n", host_stats.port1_isr);
+  printf("USART0 RX ISR calls %u\n", host_stats.usart0_isr);
+  printf("SPI0 frames/bytes   %u / %u\n", host_stats.spi_frames, host_stats.spi_bytes);
+  printf("CAN frames          %u\n", host_stats.can_frames);
+  printf("user errors         %u (last %d)\n", host_stats.errors, host_stats.last_error);
+  printf("EEPROM writes       %u\n", host_stats.eeprom_writes);
+  printf("tracker status      0x%02x\n", tracker_status);
+  printf("boards switching    %u of %d\n", fpga_spi.phases, plant_params.phases);
+
+  if(bench.step_mv != 0 && stepped){
+    printf("step                %.2f V -> %.2f V at %.3f s\n",
+	   step_from, step_to, bench.step_time);
+    printf("settling time       %.2f ms (2%% band)\n",
+	   1000.0 * (last_outside - bench.step_time));
+    printf("overshoot           %.2f V\n", peak_excursion);
+  }
+}
+
+static void
+usage(const char* name){
+  fprintf(stderr, "usage: %s [-a algorithm] [-p const|ramp|cloud|shade] [-g W/m^2] "
+	  "[-t s] [-w s] [-S mV] [-T s] [-n LSB] [-P boards] [-s seed] [-o trace.csv] "
+	  "[-c param=value[@s]] [-C s:command] [-l can.csv]\n", name);
+  exit(1);
+}
+
+int main(int argc, char** argv){
+  double duration = 10.0;
+  int c;
+
+  while((c = getopt(argc, argv, "a:p:g:t:w:S:T:n:P:s:o:c:C:l:h")) != -1){
+    switch(c){
+    case 'a': bench.algorithm = parse_algorithm(optarg); break;
+    case 'p':
+      if(strcmp(optarg, "ramp") == 0)
+	bench.profile = PROFILE_RAMP;
+      else if(strcmp(optarg, "cloud") == 0)
+	bench.profile = PROFILE_CLOUD;
+      else if(strcmp(optarg, "shade") == 0)
+	bench.profile = PROFILE_SHADE;
+      else
+	bench.profile = PROFILE_CONST;
+      break;
+    case 'g': bench.irradiance = atof(optarg); break;
+    case 't': duration = atof(optarg); break;
+    case 'w': bench.warmup = atof(optarg); break;
+    case 'S': bench.step_mv = atol(optarg); break;
+    case 'T': bench.step_time = atof(optarg); break;
+    case 'n': plant_params.noise_lsb = atof(optarg); break;
+    case 'P':
+      plant_params.phases = atoi(optarg);
+      if(plant_params.phases < 1 || plant_params.phases >= CPLD_NUM_BOARDS)
+	usage(argv[0]);
+      if(bench.num_config < BENCH_MAX_CONFIG){
+	bench.config[bench.num_config].time = -1.0;
+	bench.config[bench.num_config].param = UNSWMPPTNG_NUM_PHASES;
+	bench.config[bench.num_config].value = plant_params.phases;
+	bench.num_config++;
+      }
+      break;
+    case 's': plant_params.seed = strtoul(optarg, NULL, 0); break;
+    case 'c': parse_config(optarg); break;
+    case 'C': parse_command(optarg); break;
+    case 'l':
+      bench.can_log = fopen(optarg, "w");
+      if(bench.can_log == NULL){
+	perror(optarg);
+	return 1;
+      }
+      fprintf(bench.can_log, "t,priority,channel,value\n");
+      break;
+    case 'o':
+      bench.trace = fopen(optarg, "w");
+      if(bench.trace == NULL){
+	perror(optarg);
+	return 1;
+      }
+      fprintf(bench.trace, "t,vin,iin,vout,duty,target,irradiance,status\n");
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+
+  host_end_time = duration;
+  host_reset_registers();
+  plant_init();
+
+  if(setjmp(host_exit) == 0)
+    mpptng_main();
+
+  report();
+
+  if(bench.trace != NULL)
+    fclose(bench.trace);
+  if(bench.can_log != NULL)
+    fclose(bench.can_log);
+
+  return 0;
+}
@@ -0,0 +1,145 @@
+/* Copyright (C) agent, 2026 */
+
+/*
+ * This file is part of the UNSWMPPTNG firmware.
+ *
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Host (Linux) build of the MPPTNG firmware.
+   The firmware sources in ../src are compiled unmodified against the
+   register and scandal shims in ./include, and are driven by a
+   single-diode PV string model feeding an averaged boost converter
+   model. The CPLD is modelled at the level of its SPI registers. */
+
+#ifndef __HOST__
+#define __HOST__
+
+#include <stdint.h>
+#include <setjmp.h>
+
+/* Number of plant integration steps per ADC sequence */
+#define PLANT_SUBSTEPS          64
+
+/* Maximum number of bypass-diode protected substrings in the PV model */
+#define PV_MAX_SUBSTRINGS       8
+
+/* Number of power boards the CPLD model can address */
+#define CPLD_NUM_BOARDS         4
+
+/* Physical parameters of the plant. All SI units. */
+typedef struct plant_params_t {
+  /* PV string, per cell values at STC */
+  int    substrings;       /* Number of bypass-diode protected groups */
+  int    cells;            /* Cells per substring */
+  double isc;              /* Short circuit current (A) */
+  double voc;              /* Open circuit voltage (V) */
+  double n;                /* Diode ideality factor */
+  double rs;               /* Series resistance (ohm) */
+
+  /* Boost converter, one stage per power board */
+  int    phases;           /* Power boards fitted, 1 to CPLD_NUM_BOARDS - 1 */
+  double L;                /* Inductance, per board (H) */
+  double rl;               /* Inductor + switch resistance (ohm) */
+  double cin;              /* Input capacitance (F) */
+  double vbat;             /* Battery open circuit voltage (V) */
+  double rbat;             /* Battery + wiring resistance (ohm) */
+
+  /* Measurement */
+  double noise_lsb;        /* RMS ADC noise in LSBs */
+  uint32_t seed;           /* Noise generator seed */
+} plant_params_t;
+
+/* Live state of the plant */
+typedef struct plant_state_t {
+  double g[PV_MAX_SUBSTRINGS]; /* Irradiance per substring (W/m^2) */
+  double vc;               /* Input capacitor (PV) voltage */
+  double il;               /* Inductor current, all boards */
+  double il_board[CPLD_NUM_BOARDS]; /* Inductor current of each board */
+  double ipv;              /* PV current */
+  double vout;             /* Output (battery terminal) voltage */
+  double duty;             /* Applied duty cycle, board 1 */
+} plant_state_t;
+
+/* CPLD register model (see cpld/board.v) */
+typedef struct cpld_board_t {
+  uint16_t period;
+  uint16_t aux_length;
+  uint16_t aux_overlap;
+  uint16_t main_length;
+  uint16_t dead_time;
+  uint16_t pwm_frac;       /* Sixteenths of a count, dithered */
+  uint16_t phase;          /* Offset behind board 1 */
+} cpld_board_t;
+
+/* Counters accumulated over a run */
+typedef struct host_stats_t {
+  uint32_t adc_isr;        /* ADC12ISR invocations */
+  uint32_t timerb_isr;     /* Timer B (pv_track) invocations */
+  uint32_t port1_isr;      /* PORT1 (CAN) invocations */
+  uint32_t usart0_isr;     /* USART0 receive (CPLD SPI) invocations */
+  uint32_t spi_frames;     /* Chip-select frames to the CPLD */
+  uint32_t spi_bytes;      /* Bytes clocked on SPI0 */
+  uint32_t can_frames;     /* Frames sent by scandal */
+  uint32_t errors;         /* User errors raised, including the one at start-up */
+  uint32_t eeprom_writes;  /* sc_user_eeprom_write_block() calls */
+  int      last_error;
+  double   energy;         /* Energy taken from the PV string (J) */
+  double   energy_mpp;     /* Energy available at the MPP (J) */
+} host_stats_t;
+
+extern plant_params_t plant_params;
+extern plant_state_t  plant;
+extern cpld_board_t   cpld[CPLD_NUM_BOARDS];
+extern host_stats_t   host_stats;
+
+/* Simulated time in seconds */
+extern double         host_time;
+extern double         host_end_time;
+extern jmp_buf        host_exit;
+
+/* plant.c */
+void   plant_init(void);
+void   plant_run(double dt);
+double pv_string_current(double v);
+double pv_string_voltage(double i);
+double pv_string_mpp(double* vmp);
+void   plant_sample_adc(void);
+void   cpld_select(int selected);
+uint8_t cpld_spi_byte(uint8_t out);
+double cpld_duty(int board);
+
+/* msp430_shim.c */
+void   host_reset_registers(void);
+void   host_step(void);
+
+/* scandal_shim.c */
+double host_scale(int channel, int32_t raw);
+int32_t host_unscale(int channel, double value);
+
+/* bench.c -- called once per ADC sequence, after the interrupts */
+void   bench_tick(void);
+/* bench.c -- called at the end of scandal_init() */
+void   bench_configure(void);
+/* bench.c -- called for every channel message the firmware sends */
+void   bench_can_frame(int priority, int channel, int32_t value);
+
+/* Firmware entry points */
+int    mpptng_main(void);
+void   ADC12ISR(void);
+void   timerb0(void);
+void   port1int(void);
+void   usart0rx(void);
+
+#endif
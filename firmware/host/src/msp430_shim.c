@@ -0,0 +1,200 @@
+/* Copyright (C) agent, 2026 */
+
+/*
+ * This file is part of the UNSWMPPTNG firmware.
+ *
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* MSP430F149 register shim and interrupt dispatch for the host build.
+   Interrupts are not asynchronous here: host_step() is called from
+   handle_scandal() once per pass of the main loop, advances the plant
+   by one ADC sequence and then runs whichever handlers are due. */
+
+#include <string.h>
+
+#include <io.h>
+
+#include <project/hardware.h>
+#include <project/mpptng.h>
+
+#include "host.h"
+
+#define REG8(name)  volatile uint8_t name
+#define REG16(name) volatile uint16_t name
+
+REG8(P1IN); REG8(P1OUT); REG8(P1DIR); REG8(P1SEL);
+REG8(P1IE); REG8(P1IES); REG8(P1IFG);
+REG8(P2IN); REG8(P2OUT); REG8(P2DIR); REG8(P2SEL);
+REG8(P2IE); REG8(P2IES); REG8(P2IFG);
+REG8(P3IN); REG8(P3OUT); REG8(P3DIR); REG8(P3SEL);
+REG8(P4IN); REG8(P4OUT); REG8(P4DIR); REG8(P4SEL);
+REG8(P5IN); REG8(P5OUT); REG8(P5DIR); REG8(P5SEL);
+REG8(P6IN); REG8(P6OUT); REG8(P6DIR); REG8(P6SEL);
+
+REG8(IE1); REG8(ME1);
+REG8(BCSCTL1); REG8(BCSCTL2); REG8(DCOCTL);
+REG16(WDTCTL);
+
+REG8(U0CTL); REG8(U0TCTL); REG8(U0RCTL);
+REG8(UBR00); REG8(UBR10); REG8(UMCTL0);
+
+REG16(TBCTL); REG16(TBCCTL0); REG16(TBCCR0); REG16(TBR);
+REG16(TACTL); REG16(TACCTL0); REG16(TACCR0); REG16(TAR);
+
+REG16(ADC12CTL0); REG16(ADC12CTL1);
+REG16(ADC12IFG); REG16(ADC12IE); REG16(ADC12IV);
+REG8(ADC12MCTL0); REG8(ADC12MCTL1); REG8(ADC12MCTL2);
+REG8(ADC12MCTL3); REG8(ADC12MCTL4); REG8(ADC12MCTL5);
+REG16(ADC12MEM0); REG16(ADC12MEM1); REG16(ADC12MEM2);
+REG16(ADC12MEM3); REG16(ADC12MEM4); REG16(ADC12MEM5);
+
+volatile int host_gie;
+
+static volatile uint8_t ifg1;
+
+/* Timer B is clocked from the 32768Hz ACLK, or from SMCLK in
+   continuous mode for the ISR_STATS build */
+#define ACLK_HZ         32768.0
+#define SMCLK_HZ        7372800.0
+
+static double next_timerb;
+static uint64_t timerb_ticks;
+
+/* USART0: a byte written to TXBUF0 is shifted out (in zero time) the
+   next time the firmware touches the USART, and sets URXIFG0. Two
+   bytes written back to back give one receive flag, as they would on
+   the target if the receive interrupt was held off. */
+static uint8_t txbuf0, rxbuf0;
+static int txbuf0_full;
+
+static void
+spi0_shift(void){
+  if(txbuf0_full){
+    txbuf0_full = 0;
+    rxbuf0 = cpld_spi_byte(txbuf0);
+    ifg1 |= URXIFG0;
+  }
+}
+
+volatile uint8_t* host_ifg1(void){
+  spi0_shift();
+  ifg1 |= UTXIFG0;
+  return &ifg1;
+}
+
+volatile uint8_t* host_txbuf0(void){
+  spi0_shift();
+  txbuf0_full = 1;
+  return &txbuf0;
+}
+
+uint8_t host_spi0_rxbuf(void){
+  spi0_shift();
+  ifg1 &= ~URXIFG0;
+  return rxbuf0;
+}
+
+/* Run the USART0 receive interrupt until SPI0 goes quiet */
+static void
+usart0_run(void){
+  for(;;){
+    spi0_shift();
+    if(!(IE1 & URXIE0) || !(ifg1 & URXIFG0))
+      break;
+    U0TCTL |= TXEPT;
+    host_stats.usart0_isr++;
+    usart0rx();
+  }
+}
+
+void host_fpga_select(int selected){
+  cpld_select(selected);
+}
+
+void host_reset_registers(void){
+  host_gie = 0;
+  /* No fault from the CPLD */
+  P2IN = FS;
+  next_timerb = 0;
+  timerb_ticks = 0;
+  txbuf0_full = 0;
+  ifg1 = 0;
+}
+
+/* Continuous mode: TBR follows the simulated time and the CCR0 compare
+   fires whenever the count passes it. The ISR moves CCR0 on. */
+static void
+timerb_continuous(void){
+  double hz = ((TBCTL & TBSSEL_SMCLK) ? SMCLK_HZ : ACLK_HZ) / (1 << ((TBCTL >> 6) & 3));
+  uint64_t now = (uint64_t)(host_time * hz);
+
+  for(;;){
+    uint16_t d = TBCCR0 - (uint16_t)timerb_ticks;
+
+    if(d == 0 || timerb_ticks + d > now)
+      break;
+    timerb_ticks += d;
+    TBR = (uint16_t)now;
+    host_stats.timerb_isr++;
+    timerb0();
+    usart0_run();
+  }
+  timerb_ticks = now;
+  TBR = (uint16_t)now;
+}
+
+void host_step(void){
+  double period = 1.0 / CONTROL_FS;
+
+  plant_run(period);
+  host_time += period;
+  plant_sample_adc();
+
+  if(host_gie){
+    if((ADC12CTL0 & ENC) && (ADC12IE & (1 << 5))){
+      host_stats.adc_isr++;
+      ADC12ISR();
+      usart0_run();
+    }
+
+    if((TBCCTL0 & CCIE) && (TBCTL & MC_UPTO_CCR0) && TBCCR0 != 0){
+      double tb_period = (TBCCR0 + 1) / ACLK_HZ;
+
+      if(next_timerb == 0)
+	next_timerb = host_time + tb_period;
+      while(host_time >= next_timerb){
+	host_stats.timerb_isr++;
+	timerb0();
+	usart0_run();
+	next_timerb += tb_period;
+      }
+    }else if((TBCCTL0 & CCIE) && (TBCTL & MC_CONT)){
+      timerb_continuous();
+    }
+
+    if(P1IE & P1IFG){
+      host_stats.port1_isr++;
+      port1int();
+    }
+
+    /* Anything queued from the main loop */
+    usart0_run();
+  }
+
+  bench_tick();
+
+  if(host_time >= host_end_time)
+    longjmp(host_exit, 1);
+}
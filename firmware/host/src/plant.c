@@ -0,0 +1,412 @@
+/* Copyright (C) agent, 2026 */
+
+/*
+ * This file is part of the UNSWMPPTNG firmware.
+ *
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Plant model for the host build.
+   -- PV string: single-diode cells (shunt resistance neglected) grouped
+      into substrings, each protected by a bypass diode.
+   -- Boost converter: averaged model with the PV string on the input
+      capacitor and a battery (EMF + resistance) on the output. Each
+      power board is a boost stage with its own inductor; interleaving
+      only changes the ripple, which the averaged model doesn't have.
+   -- CPLD: the SPI register file of board.v, framed by chip select,
+      or with FPGA_LEGACY_SPI that of the 2009 image (see fpga.h). */
+
+#include <math.h>
+#include <string.h>
+
+#include <io.h>
+#include <scandal/devices.h>
+
+#include <project/hardware.h>
+
+#include "host.h"
+
+#define VT              0.025693   /* kT/q at 25 degrees C */
+#define BYPASS_DROP     0.5        /* Forward voltage of a bypass diode */
+
+plant_params_t plant_params = {
+  .substrings = 3,
+  .cells      = 40,
+  .isc        = 6.0,
+  .voc        = 0.68,
+  .n          = 1.2,
+  .rs         = 0.005,
+
+  .phases     = 1,
+  .L          = 220e-6,
+  .rl         = 0.05,
+  .cin        = 100e-6,
+  .vbat       = 130.0,
+  .rbat       = 0.2,
+
+  .noise_lsb  = 1.0,
+  .seed       = 1,
+};
+
+plant_state_t  plant;
+cpld_board_t   cpld[CPLD_NUM_BOARDS];
+
+static double  i0;                 /* Cell saturation current */
+static uint32_t noise_state;
+
+/* Registers as loaded over SPI. The counter period takes effect
+   straight away, everything else only at the end of the frame. */
+static cpld_board_t loaded[CPLD_NUM_BOARDS];
+
+static struct {
+  int      selected;
+  uint32_t shift;
+  int      bits;
+  int      words;          /* Complete words in this frame */
+  int      addr;           /* Board and signal of the last word */
+  uint8_t  status[8];      /* outblock.v snapshot, taken at select */
+  int      out;            /* Next byte of it to shift out */
+} spi;
+
+#define CPLD_CLK_HZ     40e6
+
+/* ----------------------------------------------------------------
+   PV string
+   ---------------------------------------------------------------- */
+static inline double
+substring_iph(int s){
+  return plant_params.isc * plant.g[s] / 1000.0;
+}
+
+static double
+substring_voltage(int s, double i){
+  double iph = substring_iph(s);
+  double v;
+
+  if(i >= iph)
+    return -BYPASS_DROP;
+
+  v = plant_params.cells * (plant_params.n * VT * log((iph - i) / i0 + 1.0)
+			    - i * plant_params.rs);
+  if(v < -BYPASS_DROP)
+    v = -BYPASS_DROP;
+  return v;
+}
+
+double pv_string_voltage(double i){
+  double v = 0;
+  int s;
+
+  for(s=0; s<plant_params.substrings; s++)
+    v += substring_voltage(s, i);
+  return v;
+}
+
+static double
+pv_max_iph(void){
+  double imax = 0;
+  int s;
+
+  for(s=0; s<plant_params.substrings; s++)
+    if(substring_iph(s) > imax)
+      imax = substring_iph(s);
+  return imax;
+}
+
+/* The string voltage is monotonic in current, so the current at a
+   given voltage is found by bisection. No reverse current flows. */
+double pv_string_current(double v){
+  double lo = 0, hi = pv_max_iph();
+  int k;
+
+  if(v >= pv_string_voltage(0))
+    return 0;
+  if(v <= pv_string_voltage(hi))
+    return hi;
+
+  for(k=0; k<40; k++){
+    double mid = 0.5 * (lo + hi);
+    if(pv_string_voltage(mid) > v)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return 0.5 * (lo + hi);
+}
+
+/* Global maximum power point: coarse scan (the curve may have several
+   peaks under partial shading), then golden-section refinement */
+double pv_string_mpp(double* vmp){
+  const double gr = 0.6180339887;
+  double imax = pv_max_iph();
+  double best_i = 0, best_p = 0;
+  double a, b, c, d;
+  int k;
+
+  if(imax <= 0){
+    if(vmp)
+      *vmp = 0;
+    return 0;
+  }
+
+  for(k=0; k<=200; k++){
+    double i = imax * k / 200.0;
+    double p = i * pv_string_voltage(i);
+    if(p > best_p){
+      best_p = p;
+      best_i = i;
+    }
+  }
+
+  a = best_i - imax / 200.0;
+  b = best_i + imax / 200.0;
+  if(a < 0)
+    a = 0;
+  if(b > imax)
+    b = imax;
+  for(k=0; k<40; k++){
+    c = b - gr * (b - a);
+    d = a + gr * (b - a);
+    if(c * pv_string_voltage(c) > d * pv_string_voltage(d))
+      b = d;
+    else
+      a = c;
+  }
+  best_i = 0.5 * (a + b);
+  if(vmp)
+    *vmp = pv_string_voltage(best_i);
+  return best_i * pv_string_voltage(best_i);
+}
+
+/* ----------------------------------------------------------------
+   Boost converter
+   ---------------------------------------------------------------- */
+void plant_init(void){
+  int s;
+
+  i0 = plant_params.isc / (exp(plant_params.voc / (plant_params.n * VT)) - 1.0);
+  noise_state = plant_params.seed ? plant_params.seed : 1;
+
+  for(s=0; s<PV_MAX_SUBSTRINGS; s++)
+    if(plant.g[s] == 0)
+      plant.g[s] = 1000.0;
+
+  plant.il = 0;
+  memset(plant.il_board, 0, sizeof(plant.il_board));
+  plant.duty = 0;
+  plant.vc = pv_string_voltage(0);
+  plant.ipv = 0;
+  plant.vout = plant_params.vbat;
+
+  memset(cpld, 0, sizeof(cpld));
+  memset(loaded, 0, sizeof(loaded));
+  memset(&spi, 0, sizeof(spi));
+}
+
+void plant_run(double dt){
+  double h = dt / PLANT_SUBSTEPS;
+  double pmpp;
+  double d[CPLD_NUM_BOARDS];
+  int k, b;
+
+  /* Irradiance only changes between calls */
+  pmpp = pv_string_mpp(NULL);
+
+  /* The boards are only switching while the MSP430 holds FPGA_ENABLE */
+  for(b=1; b<=plant_params.phases; b++)
+    d[b] = (P2OUT & FPGA_ENABLE) ? cpld_duty(b) : 0;
+  plant.duty = d[1];
+
+  for(k=0; k<PLANT_SUBSTEPS; k++){
+    double iout = 0;
+
+    for(b=1; b<=plant_params.phases; b++)
+      iout += plant.il_board[b] * (1.0 - d[b]);
+    plant.vout = plant_params.vbat + plant_params.rbat * iout;
+
+    plant.il = 0;
+    for(b=1; b<=plant_params.phases; b++){
+      double* il = &plant.il_board[b];
+
+      *il += h * (plant.vc - *il * plant_params.rl
+		  - (1.0 - d[b]) * plant.vout) / plant_params.L;
+      if(*il < 0)
+	*il = 0;   /* Diode blocks -- discontinuous conduction */
+      plant.il += *il;
+    }
+
+    plant.ipv = pv_string_current(plant.vc);
+    plant.vc += h * (plant.ipv - plant.il) / plant_params.cin;
+    if(plant.vc < 0)
+      plant.vc = 0;
+
+    host_stats.energy += plant.vc * plant.ipv * h;
+    host_stats.energy_mpp += pmpp * h;
+  }
+}
+
+/* Approximately Gaussian noise from the sum of four uniform samples */
+static double
+noise(void){
+  double sum = 0;
+  int k;
+
+  for(k=0; k<4; k++){
+    noise_state = noise_state * 1664525UL + 1013904223UL;
+    sum += (double)(noise_state >> 8) / (double)(1UL << 24) - 0.5;
+  }
+  return sum * sqrt(3.0) * plant_params.noise_lsb;
+}
+
+static uint16_t
+to_adc(int channel, double value){
+  double raw = host_unscale(channel, value) + noise();
+
+  if(raw < 0)
+    raw = 0;
+  if(raw > 4095)
+    raw = 4095;
+  return (uint16_t)(raw + 0.5);
+}
+
+/* Fill the ADC12MEMx registers in the sequence set up by init_adc() */
+void plant_sample_adc(void){
+  ADC12MEM0 = 1615 + 25 * 4095 / 704;                      /* 25 degrees */
+  ADC12MEM1 = to_adc(UNSWMPPTNG_HEATSINK_TEMP, 40000);
+  ADC12MEM2 = to_adc(UNSWMPPTNG_15V, 15000);
+  ADC12MEM3 = to_adc(UNSWMPPTNG_OUT_VOLTAGE, plant.vout * 1000.0);
+  ADC12MEM4 = to_adc(UNSWMPPTNG_IN_CURRENT, plant.ipv * 1000.0);
+  ADC12MEM5 = to_adc(UNSWMPPTNG_IN_VOLTAGE, plant.vc * 1000.0);
+}
+
+/* ----------------------------------------------------------------
+   CPLD
+   ---------------------------------------------------------------- */
+static void
+cpld_load(int addr, uint16_t value){
+  int board  = (addr >> 3) & 0x03;
+  int signal = addr & 0x07;
+  int b;
+
+  /* Board address 0 sets the period of every board */
+  if(board == 0){
+    for(b=0; b<CPLD_NUM_BOARDS; b++)
+      loaded[b].period = cpld[b].period = value;
+    return;
+  }
+
+  switch(signal){
+  case 0: loaded[board].period = cpld[board].period = value; break;
+  case 1: loaded[board].aux_length = value; break;
+  case 2: loaded[board].aux_overlap = value; break;
+  case 3: loaded[board].main_length = value; break;
+#ifdef FPGA_LEGACY_SPI
+  case 4: loaded[board].dead_time = value; break;
+#else
+  case 4: loaded[board].pwm_frac = value & 0x0F; break;
+  case 5: loaded[board].dead_time = value; break;
+  case 6: loaded[board].phase = value; break;
+#endif
+  }
+}
+
+#ifdef FPGA_LEGACY_SPI
+/* The 2009 inblock.v: a 16 bit shift register, loaded into the board
+   it addresses when chip select goes high. Only the last word of a
+   frame gets there. There is no outblock. */
+void cpld_select(int selected){
+  if(selected && !spi.selected){
+    spi.shift = 0;
+    spi.bits = 0;
+  }else if(!selected && spi.selected){
+    host_stats.spi_frames++;
+    if(spi.bits >= 16)
+      cpld_load((spi.shift >> 11) & 0x1F, spi.shift & 0x07FF);
+    memcpy(cpld, loaded, sizeof(cpld));
+  }
+  spi.selected = selected;
+}
+
+uint8_t cpld_spi_byte(uint8_t out){
+  host_stats.spi_bytes++;
+  if(spi.selected){
+    spi.shift = ((spi.shift << 8) | out) & 0xFFFF;
+    spi.bits += 8;
+  }
+  return 0x00;
+}
+#else
+/* inblock.v: the first word of a frame carries the address, later
+   ones go to the following signals. Everything is applied to the
+   signal generators when chip select goes high. outblock.v shifts
+   out a status snapshot of board 1 at the same time; the model has
+   no faults to report. */
+static void
+cpld_snapshot(void){
+  const cpld_board_t* b = &cpld[1];
+  uint16_t cycles = 0;
+
+  if(b->period != 0)
+    cycles = (uint16_t)(uint64_t)(host_time * CPLD_CLK_HZ / b->period);
+
+  spi.status[0] = 0;
+  spi.status[1] = 0;
+  spi.status[2] = b->main_length >> 8;
+  spi.status[3] = b->main_length & 0xFF;
+  spi.status[4] = b->period >> 8;
+  spi.status[5] = b->period & 0xFF;
+  spi.status[6] = cycles >> 8;
+  spi.status[7] = cycles & 0xFF;
+  spi.out = 0;
+}
+
+void cpld_select(int selected){
+  if(selected && !spi.selected){
+    spi.shift = 0;
+    spi.bits = 0;
+    spi.words = 0;
+    cpld_snapshot();
+  }else if(!selected && spi.selected){
+    host_stats.spi_frames++;
+    memcpy(cpld, loaded, sizeof(cpld));
+  }
+  spi.selected = selected;
+}
+
+uint8_t cpld_spi_byte(uint8_t out){
+  host_stats.spi_bytes++;
+  if(spi.selected){
+    spi.shift = (spi.shift << 8) | out;
+    spi.bits += 8;
+    if(spi.bits == 16){
+      spi.addr = spi.words++ == 0 ? (spi.shift >> 11) & 0x1F : spi.addr + 1;
+      cpld_load(spi.addr, spi.shift & 0x07FF);
+      spi.bits = 0;
+    }
+  }
+  if(spi.selected && spi.out < (int)sizeof(spi.status))
+    return spi.status[spi.out++];
+  return 0x00;
+}
+#endif
+
+double cpld_duty(int board){
+  double d;
+
+  if(cpld[board].period == 0)
+    return 0;
+  /* Averaged over the 16 cycle dither pattern */
+  d = (cpld[board].main_length + cpld[board].pwm_frac / 16.0) / (double)cpld[board].period;
+  return d > 1.0 ? 1.0 : d;
+}
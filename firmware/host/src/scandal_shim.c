@@ -0,0 +1,171 @@
+/* Copyright (C) agent, 2026 */
+
+/*
+ * This file is part of the UNSWMPPTNG firmware.
+ *
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Minimal scandal implementation for the host build.
+   Scaling follows scandal: scaled = (m * raw + b) / 1000.
+   CAN traffic is only counted. */
+
+#include <string.h>
+
+#include <scandal/types.h>
+#include <scandal/engine.h>
+#include <scandal/message.h>
+#include <scandal/error.h>
+#include <scandal/eeprom.h>
+#include <scandal/leds.h>
+#include <scandal/can.h>
+#include <scandal/obligations.h>
+
+#include "host.h"
+
+#define HOST_NUM_CHANNELS   32
+#define HOST_EEPROM_SIZE    256
+#define HOST_NODE_ADDR      1
+
+static s32 chan_m[HOST_NUM_CHANNELS];
+static s32 chan_b[HOST_NUM_CHANNELS];
+static u08 eeprom[HOST_EEPROM_SIZE];
+
+/* Timer */
+void sc_init_timer(void){
+}
+
+sc_time_t sc_get_timer(void){
+  return (sc_time_t)(host_time * 1000.0);
+}
+
+/* Engine */
+void scandal_init(void){
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  scandal_user_do_first_run();
+  bench_configure();
+}
+
+void handle_scandal(void){
+  host_step();
+}
+
+u08 scandal_get_addr(void){
+  return HOST_NODE_ADDR;
+}
+
+u32 scandal_mk_channel_id(u08 priority, u08 source, u16 channel_num){
+  return ((u32)priority << PRI_OFFSET) | ((u32)CHANNEL_TYPE << TYPE_OFFSET) |
+    ((u32)source << NODE_ADDR_OFFSET) | ((u32)channel_num << CHANNEL_NUM_OFFSET);
+}
+
+u08 scandal_send_channel(u08 priority, u16 channel_num, s32 value){
+  host_stats.can_frames++;
+  bench_can_frame(priority, channel_num, value);
+  return NO_ERR;
+}
+
+u08 scandal_send_scaled_channel(u08 priority, u16 channel_num, s32 value){
+  scandal_get_scaled_value(channel_num, &value);
+  return scandal_send_channel(priority, channel_num, value);
+}
+
+u08 scandal_get_scaled_value(u16 chan_num, s32* value){
+  *value = (s32)(((s64)*value * chan_m[chan_num] + chan_b[chan_num]) / 1000);
+  return NO_ERR;
+}
+
+u08 scandal_get_unscaled_value(u16 chan_num, s32* value){
+  if(chan_m[chan_num] == 0)
+    return NO_ERR;
+  *value = (s32)(((s64)*value * 1000 - chan_b[chan_num]) / chan_m[chan_num]);
+  return NO_ERR;
+}
+
+void scandal_set_m(u16 chan_num, s32 m){
+  chan_m[chan_num] = m;
+}
+
+void scandal_set_b(u16 chan_num, s32 b){
+  chan_b[chan_num] = b;
+}
+
+s32 scandal_get_m(u16 chan_num){
+  return chan_m[chan_num];
+}
+
+s32 scandal_get_b(u16 chan_num){
+  return chan_b[chan_num];
+}
+
+/* Floating point versions for the plant model */
+double host_scale(int channel, int32_t raw){
+  return ((double)raw * chan_m[channel] + chan_b[channel]) / 1000.0;
+}
+
+int32_t host_unscale(int channel, double value){
+  if(chan_m[channel] == 0)
+    return 0;
+  return (int32_t)((value * 1000.0 - chan_b[channel]) / chan_m[channel]);
+}
+
+/* Errors */
+void scandal_do_user_err(u08 err){
+  host_stats.errors++;
+  host_stats.last_error = err;
+  host_stats.can_frames++;
+}
+
+/* EEPROM */
+u08 sc_user_eeprom_read_block(u32 loc, u08* data, u08 length){
+  if(loc + length > HOST_EEPROM_SIZE)
+    return 1;
+  memcpy(data, &eeprom[loc], length);
+  return NO_ERR;
+}
+
+u08 sc_user_eeprom_write_block(u32 loc, u08* data, u08 length){
+  if(loc + length > HOST_EEPROM_SIZE)
+    return 1;
+  memcpy(&eeprom[loc], data, length);
+  host_stats.eeprom_writes++;
+  return NO_ERR;
+}
+
+/* LEDs */
+void red_led(u08 on){
+}
+
+void yellow_led(u08 on){
+}
+
+void toggle_red_led(void){
+}
+
+void toggle_yellow_led(void){
+}
+
+/* CAN */
+void can_interrupt(void){
+}
+
+/* Raw frames are logged with the first four data bytes as the value */
+u08 can_send_msg(can_msg* msg, u08 priority){
+  s32 value = ((s32)msg->data[0] << 24) | ((s32)msg->data[1] << 16) |
+    ((s32)msg->data[2] << 8) | msg->data[3];
+
+  host_stats.can_frames++;
+  bench_can_frame(priority, msg->id & 0x3FF, value);
+  return NO_ERR;
+}
@@ -0,0 +1,112 @@
+/* Copyright (C) agent, 2026 */
+
+/*
+ * This file is part of the UNSWMPPTNG firmware.
+ *
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Relay auto-tuner for the input loop
+   --
+   Started with UNSWMPPTNG_COMMAND_SET_AND_TUNE:
+     data[0..3] input voltage target, mV, big-endian
+     data[4]    AUTOTUNE_x flags
+     data[5]    relay amplitude, CPLD PWM counts (0 for AUTOTUNE_DEFAULT_RELAY)
+   The tracker is put in manual mode at the target and left for
+   AUTOTUNE_SETTLE_TIME on the present gains. The input loop is then
+   replaced by a relay about the output it settled at: the PWM steps up
+   by the relay amplitude while Vin is above the target, and down while
+   it is below. That sets Vin oscillating at the loop's ultimate period
+   Tu, with an amplitude a that gives the ultimate gain,
+   Ku = 4 * relay / (pi * a) (Astrom and Hagglund). Gains are worked
+   out from Ku and Tu, and the input loop picks up where the relay
+   left off.
+   The results go out as channel messages on UNSWMPPTNG_TUNE_KU (0 if
+   the experiment failed), _TU (us), _KP, _KI and _KD, as config values
+   for the present board count and gain schedule band. With
+   AUTOTUNE_COMMIT they are also taken into config.in_pid_const.
+   The relay runs in the ADC ISR (autotune_relay() below), the rest from
+   the main loop (autotune_poll()). */
+
+#ifndef __AUTOTUNE__
+#define __AUTOTUNE__
+
+#include <scandal/types.h>
+
+#include <project/control.h>
+
+/* Flags, data[4] */
+#define AUTOTUNE_COMMIT         0x01 /* Write the gains to the config */
+
+#define AUTOTUNE_DEFAULT_RELAY  16   /* CPLD PWM counts */
+#define AUTOTUNE_SETTLE_TIME    300  /* ms at the target before the relay */
+#define AUTOTUNE_TIMEOUT        2000 /* ms for the relay to finish */
+#define AUTOTUNE_HYSTERESIS     1    /* ADC counts either side of the target */
+#define AUTOTUNE_SKIP_CYCLES    2    /* Oscillations to let settle */
+#define AUTOTUNE_CYCLES         8    /* Oscillations averaged */
+#define AUTOTUNE_MIN_AMPLITUDE  4    /* ADC counts peak to peak, or it's noise */
+
+#define AUTOTUNE_IDLE           0
+#define AUTOTUNE_SETTLE         1
+#define AUTOTUNE_RELAY          2
+#define AUTOTUNE_DONE           3
+
+typedef struct autotune_state_t {
+  uint8_t  state;         /* AUTOTUNE_x */
+  uint8_t  flags;         /* AUTOTUNE_x */
+  uint8_t  high;          /* Relay output high */
+  uint8_t  cycles;        /* Relay cycles started */
+  int32_t  bias;          /* Input loop output the relay is about */
+  int32_t  relay;         /* Relay amplitude, control loop units */
+  uint16_t samples;       /* ADC sequences since the relay started */
+  uint16_t last_switch;   /* samples at the start of this cycle */
+  uint16_t period_sum;    /* Samples in the cycles measured */
+  uint16_t amplitude_sum; /* Peak to peak ADC counts, summed likewise */
+  int16_t  emax, emin;    /* Error extremes this cycle */
+  sc_time_t started;
+} autotune_state_t;
+
+extern volatile autotune_state_t autotune;
+
+void autotune_start(u08* data);
+void autotune_poll(void);
+
+/* Called from the ADC ISR in place of the input loop PID while
+   autotune.state is AUTOTUNE_RELAY. ek is Vin - target in ADC counts.
+   A cycle starts with each switch of the relay to high. */
+static inline int32_t autotune_relay(int16_t ek){
+  autotune.samples++;
+  if(ek > autotune.emax)
+    autotune.emax = ek;
+  if(ek < autotune.emin)
+    autotune.emin = ek;
+
+  if(!autotune.high && ek > AUTOTUNE_HYSTERESIS){
+    autotune.high = 1;
+    if(autotune.cycles > AUTOTUNE_SKIP_CYCLES){
+      autotune.period_sum += autotune.samples - autotune.last_switch;
+      autotune.amplitude_sum += autotune.emax - autotune.emin;
+    }
+    autotune.last_switch = autotune.samples;
+    autotune.emax = autotune.emin = ek;
+    if(++autotune.cycles > AUTOTUNE_SKIP_CYCLES + AUTOTUNE_CYCLES)
+      autotune.state = AUTOTUNE_DONE;
+  }else if(autotune.high && ek < -AUTOTUNE_HYSTERESIS){
+    autotune.high = 0;
+  }
+
+  return autotune.high ? autotune.bias + autotune.relay : autotune.bias - autotune.relay;
+}
+
+#endif
@@ -0,0 +1,102 @@
+/* Copyright (C) agent, 2026 */
+
+/*
+ * This file is part of the UNSWMPPTNG firmware.
+ *
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Calibration cache
+   --
+   scandal scales a channel as (m * raw + b) / 1000, and goes back with
+   (value * 1000 - b) / m, both with a 32 bit divide. For the channels
+   the tracker converts while tracking, the m and b are turned into a
+   multiply, an add and a shift each way, here, whenever they change:
+     scaled = (raw * scale_mul + scale_add) >> scale_shift
+     raw    = ((value - unscale_off) * unscale_mul + unscale_round) >> unscale_shift
+   The shifts are as large as the products of a 12 bit reading (or a
+   value within the scaled range of one) will allow in 32 bits, and
+   both come out rounded to the nearest mV or ADC count. Values beyond
+   the scaled range of the ADC are clamped to it on the way back.
+   calibration_poll() runs from the main loop and rebuilds the cache,
+   and everything derived from it, when scandal's m or b change. It
+   also keeps a reciprocal of Vout, for the duty feed-forward, so that
+   there's no divide left for the Timer B ISR when the target moves. */
+
+#ifndef __CALIBRATION__
+#define __CALIBRATION__
+
+#include <scandal/types.h>
+
+/* Channels cached, indices into calibration[] */
+#define CAL_VIN                 0   /* UNSWMPPTNG_IN_VOLTAGE */
+#define CAL_IIN                 1   /* UNSWMPPTNG_IN_CURRENT */
+#define CAL_VOUT                2   /* UNSWMPPTNG_OUT_VOLTAGE */
+#define CAL_NUM_CHANNELS        3
+
+#define CAL_ADC_FULL_SCALE      4095
+#define CAL_MAX_SHIFT           24
+
+typedef struct calibration_t {
+  int32_t  m, b;           /* scandal's, as the cache was built from */
+  int32_t  scale_mul;
+  int32_t  scale_add;      /* With the rounding */
+  uint8_t  scale_shift;
+  uint8_t  unscale_shift;
+  int32_t  unscale_off;    /* b / 1000 */
+  int32_t  unscale_max;    /* |value - unscale_off| the ADC can read */
+  int32_t  unscale_mul;
+  int32_t  unscale_round;
+} calibration_t;
+
+extern volatile calibration_t calibration[CAL_NUM_CHANNELS];
+
+/* Vout reciprocal -- board 1's programmed PWM period over the present
+   Vout, in counts per mV << CAL_RECIP_SHIFT. Below CAL_RECIP_MIN_VOUT
+   per_mv is 0. While vin < vout, vin * per_mv stays within 32 bits. */
+#define CAL_RECIP_SHIFT         16
+#define CAL_RECIP_MIN_VOUT      1000  /* mV */
+
+typedef struct calibration_recip_t {
+  int32_t  vout;           /* mV, as per_mv was taken from */
+  int32_t  per_mv;
+  uint16_t period;         /* PWM counts */
+} calibration_recip_t;
+
+extern volatile calibration_recip_t calibration_recip;
+
+void calibration_update(void);
+void calibration_poll(void);
+
+/* ADC reading to mV (or mA) */
+static inline int32_t
+calibration_scale(uint8_t c, int32_t raw){
+  return (raw * calibration[c].scale_mul + calibration[c].scale_add)
+    >> calibration[c].scale_shift;
+}
+
+/* mV (or mA) to ADC reading */
+static inline int32_t
+calibration_unscale(uint8_t c, int32_t value){
+  value -= calibration[c].unscale_off;
+  if(value > calibration[c].unscale_max)
+    value = calibration[c].unscale_max;
+  else if(value < -calibration[c].unscale_max)
+    value = -calibration[c].unscale_max;
+
+  return (value * calibration[c].unscale_mul + calibration[c].unscale_round)
+    >> calibration[c].unscale_shift;
+}
+
+#endif
@@ -22,7 +22,26 @@
 
 #include <project/mpptng.h>
 
+/* The config is kept as a journal of records in the user EEPROM, which 
+   on the MSP430F149 is information memory: two 128 byte flash segments, 
+   each erased as a whole on a write. Each segment holds whole records, 
+   and each write goes to the slot after the newest record, so the 
+   previous record is never in the segment being erased. */ 
+#define CONFIG_JOURNAL_SIZE     256
+#define CONFIG_SEGMENT_SIZE     128
+
+/* Bump whenever mpptng_config_t changes. Records from an older layout 
+   are ignored and the defaults are loaded. */ 
+#define CONFIG_VERSION          3
+
+/* A change over CAN is written CONFIG_WRITE_DELAY ms after the last one, 
+   so that a tuning session is one write rather than one per change */ 
+#define CONFIG_WRITE_DELAY      5000
+
+void config_defaults(void);
 void config_read(void);
 int config_write(void);
+void config_changed(void);
+void config_flush(void);
 
 #endif
@@ -28,6 +28,8 @@ void control_set_voltage(int32_t mvolts);
 void control_set_raw(int16_t raw);
 int32_t control_get_target(void);
 int control_is_saturated(void);
+void control_update_phases(void);
+void control_update_gains(void);
 
 volatile void set_max_vout_adc(uint16_t new_vout_adc);
 volatile void set_min_vin_adc(uint16_t new_vin_adc);
@@ -36,6 +38,40 @@ volatile void update_control_maxmin(void);
 void adc_acc_read_and_zero(int i, uint32_t* value, uint16_t* num);
 uint32_t adc_acc_read_zero_divide(int i);
 
+/* ADC filter bank 
+   -- 
+   Every channel goes through a cascade of ADC_FILTER_ORDER_x first 
+   order IIR stages, y += (x - y) >> ADC_FILTER_SHIFT_x, for 
+   sample_adc(). The time constant of each stage is roughly 
+   2^ADC_FILTER_SHIFT_x samples at CONTROL_FS. 
+   The state keeps ADC_FILTER_FRAC_BITS below the 12 bit reading, 
+   which still fits the difference in 16 bit arithmetic. 
+
+   Vin and Iin are also integrated for pv_track (a first order CIC 
+   decimator: the ISR integrates, adc_acc_read_and_zero() combs). */ 
+#define ADC_FILTER_FRAC_BITS      3
+#define ADC_FILTER_MAX_ORDER      2
+
+#define ADC_FILTER_ORDER_TAMBIENT   2
+#define ADC_FILTER_SHIFT_TAMBIENT   5
+#define ADC_FILTER_ORDER_THEATSINK  2
+#define ADC_FILTER_SHIFT_THEATSINK  5
+#define ADC_FILTER_ORDER_15V        1
+#define ADC_FILTER_SHIFT_15V        3
+#define ADC_FILTER_ORDER_VOUT       1
+#define ADC_FILTER_SHIFT_VOUT       2
+#define ADC_FILTER_ORDER_IIN1       1
+#define ADC_FILTER_SHIFT_IIN1       2
+#define ADC_FILTER_ORDER_VIN1       1
+#define ADC_FILTER_SHIFT_VIN1       2
+
+/* Control loop output units: CPLD PWM counts << 14 */ 
+#define OUTPUT_TO_PWM(x) (((int32_t)x) >> 14)
+#define PWM_TO_OUTPUT(x) (((int32_t)x) << 14)
+
+#define OUT_MAX PWM_TO_OUTPUT(PWM_MAX)
+#define OUT_MIN PWM_TO_OUTPUT(PWM_MIN)
+
 typedef struct pid_data_t {
 	/* Variables */
   int32_t uk_1; /* Previous PI output */
@@ -49,6 +85,9 @@ typedef struct pid_const_t {
         int32_t Kd; 
 } pid_const_t; 
 
+void control_store_in_gains(pid_const_t* gains);
+void control_resume_input_loop(int32_t uk);
+
 /* Active loop constants */ 
 #define INPUT_LOOP      0
 #define OUTPUT_LOOP     1
@@ -56,5 +95,6 @@ typedef struct pid_const_t {
 extern volatile int     active_loop; 
 extern volatile int32_t output; 
 extern volatile int32_t control_error; /* Get rid of this! */ 
+extern volatile pid_data_t in_pid_data; 
 
 #endif
@@ -18,7 +18,7 @@
  */
 
 #ifndef __FPGA__
-#define __FGPA__
+#define __FPGA__
 
 #include <project/hardware.h>
 #include <scandal/types.h>
@@ -35,21 +35,147 @@
 #define SIGNAL_AUX_LENGTH    1
 #define SIGNAL_AUX_OVERLAP   2
 #define SIGNAL_PWM           3
-#define SIGNAL_DEADTIME      4
+#define SIGNAL_PWM_FRAC      4    /* Sixteenths of a count, dithered (see dither.v) */ 
+#define SIGNAL_DEADTIME      5
+#define SIGNAL_PHASE         6    /* Boards 2 and 3: offset behind board 1 (see board.v) */ 
+#define FPGA_NUM_SIGNALS     7
+
+/* fpga_setpwm() takes the PWM with this many fractional bits */ 
+#define FPGA_PWM_FRAC_BITS   4
+#define PWM_TO_FPGA(x)       ((x) << FPGA_PWM_FRAC_BITS)
+
+/* Interleaved power boards 
+   -- 
+   Board 1 sets the switching frequency. Boards 2 and 3, where the 
+   CPLD is built for them (PHASES in NgControlCpld.v), follow its 
+   counter a phase register's worth behind. fpga_set_phases() picks 
+   how many of them switch, spread evenly over the cycle; the rest 
+   are shed with their aux and main pulses off. Every board that 
+   switches gets the same PWM. */ 
+#define FPGA_BOARD           1    /* The first board */ 
+#define FPGA_NUM_BOARDS      3
+#define FPGA_CYCLE_CLKS(p)   ((p) + 5)  /* Length of a switching cycle, period p (counter.v) */ 
+#define FPGA_PHASE_LOCK      2    /* Clocks from board 1 reaching the phase to the restart */ 
+
+/* The image the CPLD is programmed with 
+   -- 
+   The .pof in cpld/ is still the July 2009 build (see the notes in 
+   NgControlCpld.v), which predates everything below: it takes one 
+   word per chip select, needs a byte clocked with chip select high 
+   to finish loading it, has the dead time at register 4, no PWM 
+   fraction or phase registers, one board and no readback. Built 
+   with FPGA_LEGACY_SPI (the default in the target makefile until the 
+   image is rebuilt) the firmware keeps its registers as below but 
+   sends them that way. The PWM fraction and phase are kept but never 
+   sent, registers written together go out one frame each, and 
+   fpga_readback stays empty. */ 
+#ifdef FPGA_LEGACY_SPI
+#define FPGA_MAX_PHASES      1
+#define FPGA_SIGNALS_SENT    (~((1 << SIGNAL_PWM_FRAC) | (1 << SIGNAL_PHASE)))
+#else
+#define FPGA_MAX_PHASES      FPGA_NUM_BOARDS
+#define FPGA_SIGNALS_SENT    0xFF
+#endif
+
+/* A frame is one or more 16 bit words under a single chip select. 
+   The first word carries the board and signal address, later words 
+   go to the following signals (see inblock.v). The CPLD applies all 
+   of them together when chip select goes high. 
+
+   Register writes after fpga_init() are interrupt driven. 
+   fpga_queue() records the new value and, if SPI0 is idle, starts a 
+   frame covering every register that is waiting, loading the first 
+   word into the (double buffered) USART before returning. Each time 
+   the USART0 receive interrupt finds the shift register empty it 
+   sends the next word, or raises chip select and starts the next 
+   frame. A write of the value the register already holds is dropped, 
+   and repeated writes to a register while SPI0 is busy only send 
+   the latest value. A frame only ever goes to one board. 
+
+   The CPLD sends a status snapshot back during every frame (see 
+   outblock.v). Reading it needs a frame of at least four words, sent 
+   a byte at a time so that no received byte is overwritten, so it is 
+   only done when asked for: fpga_queue_readback() rewrites the aux 
+   timing, PWM and PWM fraction registers of board 1 with the values 
+   they already hold and keeps what comes back in fpga_readback. */ 
+#define FPGA_SPI_IDLE        0
+#define FPGA_SPI_FRAME       1    /* Chip select low, frame in flight */ 
+#define FPGA_SPI_READ        2    /* As above, a byte at a time, keeping what comes back */ 
+#define FPGA_SPI_TRAIL       3    /* FPGA_LEGACY_SPI: chip select high, trailing byte in flight */ 
+
+/* Registers rewritten by a readback frame: 1 (aux length) to 4 (PWM fraction) */ 
+#define FPGA_READBACK_SIGNALS 0x1E
+#define FPGA_READBACK_BYTES  8
+
+/* Fault bits in the readback, as faults.v */ 
+#define FPGA_FAULT_VOLT      0x01
+#define FPGA_FAULT_REG15     0x02
+#define FPGA_FAULT_REG5      0x04
+#define FPGA_FAULT_CURRENT   0x08 /* The current limiter has cut a pulse short */ 
+#define FPGA_FAULT_MSPRESET  0x10
+#define FPGA_FAULT_FPGARESET 0x20
+#define FPGA_FAULT_LIMIT     0x40 /* Only in cause: 4 cycles in a row current limited */ 
+#define FPGA_LIVE_LIMITING   0x40 /* Only in live: the last cycle was current limited */ 
+#define FPGA_LIVE_SD         0x80 /* Only in live: the board is shut down */ 
+
+typedef struct fpga_spi_t {
+  uint8_t  state;                      /* FPGA_SPI_x */ 
+  uint8_t  phases;                     /* Boards switching, from FPGA_BOARD up */ 
+  uint8_t  dirty[FPGA_NUM_BOARDS];     /* 1 << signal for each register waiting */ 
+  uint8_t  read;                       /* A readback is waiting */ 
+  uint8_t  next;                       /* Next byte of the frame to send */ 
+  uint8_t  count;                      /* Bytes in the frame */ 
+  uint16_t value[FPGA_NUM_BOARDS][FPGA_NUM_SIGNALS]; /* Latest value of each register */ 
+  uint8_t  frame[FPGA_NUM_SIGNALS * 2]; /* The frame in flight */ 
+  uint8_t  rx[FPGA_READBACK_BYTES];    /* What has come back so far */ 
+} fpga_spi_t; 
+
+typedef struct fpga_readback_t {
+  uint8_t  cause;                      /* FPGA_FAULT_x seen since the last fs_reset() */ 
+  uint8_t  live;                       /* FPGA_FAULT_x active now | FPGA_LIVE_SD */ 
+  uint16_t main_length;                /* PWM applied by the CPLD */ 
+  uint16_t period; 
+  uint16_t cycles;                     /* Switching cycles, wraps */ 
+  uint8_t  count;                      /* Readbacks completed, wraps */ 
+} fpga_readback_t; 
+
+extern volatile fpga_spi_t fpga_spi; 
+extern volatile fpga_readback_t fpga_readback; 
 
 /* Prototypes */ 
 void fpga_init(void);
-static inline void fpga_transfer(u08 board, u08 signal, u16 value);
+void fpga_write(u08 signal, u16 value);
+void fpga_write_burst(u08 signal, const u16* values, u08 count);
+void fpga_write_pwm(u16 value);
+void fpga_request_readback(void);
+void fpga_set_phases(u08 phases);
+void fpga_send_telemetry(void);
+void fpga_send_data(void);
+static inline void fpga_transfer(u08 board, u08 signal, const u16* values, u08 count);
+static inline void fpga_mark(u08 board, u08 signal, u16 value);
+static inline void fpga_kick(void);
+static inline void fpga_queue(u08 board, u08 signal, u16 value);
 
 /* Static functions you should use */ 
+/* Called from the ADC ISR, or with interrupts disabled. 
+   Use fpga_write_pwm() anywhere else. 
+   value is in 1/2^FPGA_PWM_FRAC_BITS counts, see PWM_TO_FPGA(). The 
+   whole counts and the fraction go out in one frame, one per board 
+   that is switching. */ 
 static inline void 
 fpga_setpwm(uint16_t value){
-    if(value > PWM_MAX)
-        value = PWM_MAX;
-    else if(value < PWM_MIN)
-        value = PWM_MIN; 
+    u08 board; 
 
-    fpga_transfer(1, SIGNAL_PWM, value); 
+    if(value > PWM_TO_FPGA(PWM_MAX))
+        value = PWM_TO_FPGA(PWM_MAX);
+    else if(value < PWM_TO_FPGA(PWM_MIN))
+        value = PWM_TO_FPGA(PWM_MIN); 
+
+    for(board = FPGA_BOARD; board < FPGA_BOARD + fpga_spi.phases; board++){
+        fpga_mark(board, SIGNAL_PWM, value >> FPGA_PWM_FRAC_BITS); 
+        fpga_mark(board, SIGNAL_PWM_FRAC, value & ((1 << FPGA_PWM_FRAC_BITS) - 1)); 
+    }
+    fpga_kick(); 
 }
 
 static inline void 
@@ -84,21 +210,167 @@ fpga_nFS(void){
    but are here for speed */ 
 /* -------------------------------------------------- */ 
 
-static inline void 
-fpga_transfer(u08 board, u08 signal, u16 value){
+static inline u16 
+fpga_word(u08 board, u08 signal, u16 value){
     u16 transfer = 0; 
 
 	transfer |= ((u16)board & 0x03) << 14;
 	transfer |= ((u16)signal & 0x07) << 11; 
 	transfer |= (value & 0x07FF) << 0; 
 
+	return transfer; 
+}
+
+#ifdef FPGA_LEGACY_SPI
+/* Register address in the 2009 image, for the signals it has */ 
+static inline u08 
+fpga_legacy_address(u08 signal){
+    return signal == SIGNAL_DEADTIME ? 4 : signal; 
+}
+
+/* Blocking write, one frame per register, only used before the SPI0 
+   interrupt is enabled */ 
+static inline void 
+fpga_transfer(u08 board, u08 signal, const u16* values, u08 count){
+    for(; count != 0; count--, signal++, values++){
+        u16 transfer; 
+
+        if((FPGA_SIGNALS_SENT & (1 << signal)) == 0)
+            continue; 
+        transfer = fpga_word(board, fpga_legacy_address(signal), *values); 
+
+        ENABLE_FPGA_SPI(); 
+        spi0_transfer((transfer >> 8) & 0xFF); 
+        spi0_transfer(transfer & 0xFF); 
+        DISABLE_FPGA_SPI(); 
+
+        spi0_transfer(0x00); 
+    }
+}
+#else
+/* Blocking burst write, only used before the SPI0 interrupt is enabled */ 
+static inline void 
+fpga_transfer(u08 board, u08 signal, const u16* values, u08 count){
     ENABLE_FPGA_SPI(); 
-    spi0_transfer((transfer >> 8) & 0xFF); 
-	spi0_transfer(transfer & 0xFF); 
-	DISABLE_FPGA_SPI(); 
+    for(; count != 0; count--, signal++, values++){
+        u16 transfer = fpga_word(board, signal, *values); 
 
-	spi0_transfer(0x00); 
+        spi0_transfer((transfer >> 8) & 0xFF); 
+        spi0_transfer(transfer & 0xFF); 
+    }
+    DISABLE_FPGA_SPI(); 
 }
+#endif
+
+/* Anything waiting, on any board */ 
+static inline u08 
+fpga_dirty(void){
+    return fpga_spi.dirty[0] | fpga_spi.dirty[1] | fpga_spi.dirty[2]; 
+}
+
+#ifdef FPGA_LEGACY_SPI
+/* Send the lowest numbered register waiting on the lowest numbered 
+   board. SPI0 must be idle. */ 
+static inline void 
+fpga_spi_start(void){
+    u08 b, signal; 
+    u16 transfer; 
 
+    for(b = 0; fpga_spi.dirty[b] == 0; b++)
+        ; 
+    for(signal = 0; (fpga_spi.dirty[b] & (1 << signal)) == 0; signal++)
+        ; 
+    fpga_spi.dirty[b] &= ~(1 << signal); 
+    transfer = fpga_word(FPGA_BOARD + b, fpga_legacy_address(signal), 
+                         fpga_spi.value[b][signal]); 
+
+    fpga_spi.state = FPGA_SPI_FRAME; 
+    ENABLE_FPGA_SPI(); 
+    spi0_send((transfer >> 8) & 0xFF); 
+    spi0_send(transfer & 0xFF); 
+}
+#else
+/* Send every register of the lowest numbered board with any waiting, 
+   from the lowest to the highest numbered one, in one frame, or a 
+   readback. The other boards are left for the frames that follow. 
+   SPI0 must be idle. */ 
+static inline void 
+fpga_spi_start(void){
+    u08 b, lo, hi, i; 
+    volatile u08* dirty; 
+
+    if(fpga_spi.read)
+        fpga_spi.dirty[0] |= FPGA_READBACK_SIGNALS; 
+
+    for(b = 0; fpga_spi.dirty[b] == 0; b++)
+        ; 
+    dirty = &fpga_spi.dirty[b]; 
+
+    for(lo = 0; (*dirty & (1 << lo)) == 0; lo++)
+        ; 
+    for(hi = FPGA_NUM_SIGNALS - 1; (*dirty & (1 << hi)) == 0; hi--)
+        ; 
+    *dirty = 0; 
+
+    /* Later words only need the value, but carry their address anyway 
+       so that the frame reads sensibly on a logic analyser */ 
+    for(i = 0; lo <= hi; lo++){
+        u16 transfer = fpga_word(FPGA_BOARD + b, lo, fpga_spi.value[b][lo]); 
+
+        fpga_spi.frame[i++] = transfer >> 8; 
+        fpga_spi.frame[i++] = transfer & 0xFF; 
+    }
+    fpga_spi.count = i; 
+
+    ENABLE_FPGA_SPI(); 
+    if(fpga_spi.read){
+        fpga_spi.read = 0; 
+        fpga_spi.state = FPGA_SPI_READ; 
+        fpga_spi.next = 1; 
+        spi0_send(fpga_spi.frame[0]); 
+    }else{
+        fpga_spi.state = FPGA_SPI_FRAME; 
+        fpga_spi.next = 2; 
+        spi0_send(fpga_spi.frame[0]); 
+        spi0_send(fpga_spi.frame[1]); 
+    }
+}
+#endif
+
+/* Record a new register value without starting a frame */ 
+static inline void 
+fpga_mark(u08 board, u08 signal, u16 value){
+    board -= FPGA_BOARD; 
+    if(fpga_spi.value[board][signal] == value)
+        return; 
+
+    fpga_spi.value[board][signal] = value; 
+    fpga_spi.dirty[board] |= (1 << signal) & FPGA_SIGNALS_SENT; 
+}
+
+/* Start a frame if anything is waiting and SPI0 is idle */ 
+static inline void 
+fpga_kick(void){
+    if(fpga_dirty() && fpga_spi.state == FPGA_SPI_IDLE)
+        fpga_spi_start(); 
+}
+
+static inline void 
+fpga_queue(u08 board, u08 signal, u16 value){
+    fpga_mark(board, signal, value); 
+    fpga_kick(); 
+}
+
+/* Called from an ISR, or with interrupts disabled. 
+   Use fpga_request_readback() anywhere else. */ 
+static inline void 
+fpga_queue_readback(void){
+#ifndef FPGA_LEGACY_SPI
+    fpga_spi.read = 1; 
+
+    if(fpga_spi.state == FPGA_SPI_IDLE)
+        fpga_spi_start(); 
 #endif
+}
 
+#endif
@@ -0,0 +1,136 @@
+/* Copyright (C) agent, 2026 */ 
+
+/* 
+ * This file is part of the UNSWMPPTNG firmware.
+ * 
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ 
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ 
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* ISR timing instrumentation 
+   -- 
+   Build with ISR_STATS=1 (make ISR_STATS=1) to time the ADC, Timer B, 
+   PORT1 and USART0 receive ISRs. Timer B then runs continuously from 
+   SMCLK / 8 and pv_track is scheduled from its CCR0 compare, so TBR is 
+   a free-running timestamp with 8 cycle resolution. 
+
+   For every ISR we keep the min/max/mean execution time and a 
+   histogram of entry jitter: 
+     ADC      cycle-to-cycle change in the time between entries 
+     Timer B  latency from the CCR0 compare to entry 
+     PORT1    none (aperiodic) 
+     SPI0     none (follows the ADC ISR) 
+   Bins are 0, 1, 2-3, 4-7, 8-15 and >= 16 ticks (x8 for cycles). 
+
+   UNSWMPPTNG_COMMAND_ISR_STATS snapshots and clears the statistics and 
+   sends four frames per ISR on UNSWMPPTNG_ISR_STATS, times in cycles, 
+   big-endian: 
+     [id][0][min u16][max u16][mean u16] 
+     [id][1][count u24][max jitter u16][0] 
+     [id][2][bin 0..2, u16 each] 
+     [id][3][bin 3..5, u16 each] */ 
+
+#ifndef __ISR_STATS__
+#define __ISR_STATS__
+
+#ifndef ISR_STATS
+#define ISR_STATS                0
+#endif
+
+#define ISR_STATS_ADC            0
+#define ISR_STATS_TIMERB         1
+#define ISR_STATS_PORT1          2
+#define ISR_STATS_SPI0           3
+#define ISR_STATS_NUM            4
+
+#define ISR_STATS_HIST_BINS      6
+#define ISR_STATS_FRAMES         4     /* Per ISR */ 
+#define ISR_STATS_SEND_BURST     4     /* Messages per pass of the main loop */ 
+
+#define ISR_STATS_SMCLK          7372800L
+#define ISR_STATS_TICK_SHIFT     3     /* Timer B runs at SMCLK / 8 */ 
+#define ISR_STATS_TICK_HZ        (ISR_STATS_SMCLK >> ISR_STATS_TICK_SHIFT)
+
+typedef struct isr_stats_t {
+  uint16_t min;                 /* Execution time, ticks */ 
+  uint16_t max; 
+  uint32_t total; 
+  uint32_t count; 
+  uint16_t last_entry; 
+  uint16_t last_interval; 
+  uint8_t  primed;              /* Entries seen, up to 2 */ 
+  uint16_t max_jitter;          /* ticks */ 
+  uint16_t hist[ISR_STATS_HIST_BINS]; 
+} isr_stats_t; 
+
+void isr_stats_init(void); 
+int  isr_stats_send(void); 
+void isr_stats_send_data(void); 
+
+#if ISR_STATS
+
+extern volatile isr_stats_t isr_stats[ISR_STATS_NUM]; 
+
+#define ISR_STATS_ENTER()          uint16_t isr_stats_entry = TBR
+#define ISR_STATS_EXIT(id, jitter) isr_stats_record((id), isr_stats_entry, (jitter))
+
+/* Change in the interval between entries since the last one */ 
+static inline uint16_t 
+isr_stats_interval_jitter(int id, uint16_t entry){
+  volatile isr_stats_t* s = &isr_stats[id]; 
+  uint16_t interval = entry - s->last_entry; 
+  uint16_t jitter; 
+
+  jitter = interval > s->last_interval ? 
+    interval - s->last_interval : s->last_interval - interval; 
+
+  /* Nothing to compare with for the first two entries */ 
+  if(s->primed < 2){
+    s->primed++; 
+    jitter = 0; 
+  }
+
+  s->last_entry = entry; 
+  s->last_interval = interval; 
+  return jitter; 
+}
+
+static inline void 
+isr_stats_record(int id, uint16_t entry, uint16_t jitter){
+  volatile isr_stats_t* s = &isr_stats[id]; 
+  uint16_t duration = TBR - entry; 
+  int bin; 
+
+  if(duration < s->min)
+    s->min = duration; 
+  if(duration > s->max)
+    s->max = duration; 
+  s->total += duration; 
+  s->count++; 
+
+  if(jitter > s->max_jitter)
+    s->max_jitter = jitter; 
+  for(bin = 0; bin < ISR_STATS_HIST_BINS - 1 && jitter >= (1 << bin); bin++)
+    ; 
+  if(s->hist[bin] != 0xFFFF)
+    s->hist[bin]++; 
+}
+
+#else
+
+#define ISR_STATS_ENTER()
+#define ISR_STATS_EXIT(id, jitter)
+
+#endif
+
+#endif
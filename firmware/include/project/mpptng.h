@@ -46,7 +46,95 @@
 #define MPPTNG_INCCOND         2
 #define MPPTNG_IVSWEEP         3
 #define MPPTNG_MANUAL          4
-#define MPPTNG_NUM_ALGORITHMS  5
+#define MPPTNG_GMPPT           5    /* Periodic global scan + local tracking */ 
+#define MPPTNG_VSPANDO         6    /* Variable step P & O */ 
+#define MPPTNG_NUM_ALGORITHMS  7
+
+/* Configuration parameters added since the UNSWMPPTNG entry in 
+   scandal/devices.h was last updated. They follow on from the 
+   last parameter defined there. */ 
+#ifndef UNSWMPPTNG_GMPPT_SCAN_PERIOD
+#define UNSWMPPTNG_GMPPT_SCAN_PERIOD       (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 1)
+#define UNSWMPPTNG_GMPPT_SAMPLE_PERIOD     (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 2)
+#define UNSWMPPTNG_GMPPT_STEP_SIZE         (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 3)
+#define UNSWMPPTNG_GMPPT_LOCAL_ALGORITHM   (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 4)
+#define UNSWMPPTNG_PANDO_UPDATE_PERIOD     (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 5)
+#define UNSWMPPTNG_VSPANDO_MIN_STEP        (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 6)
+#define UNSWMPPTNG_VSPANDO_MAX_STEP        (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 7)
+#define UNSWMPPTNG_VSPANDO_GAIN            (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 8)
+#define UNSWMPPTNG_IVSWEEP_NUM_POINTS      (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 9)
+#define UNSWMPPTNG_TELEMETRY_MODE          (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 10)
+#define UNSWMPPTNG_NUM_PHASES              (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 11)
+#define UNSWMPPTNG_PHASE_CURRENT           (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 12)
+#define UNSWMPPTNG_GAIN_BAND_CURRENT       (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 13)
+/* GAIN_SCHEDULE_BANDS parameters each, band 0 first */ 
+#define UNSWMPPTNG_IN_GAIN_SCHEDULE        (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 14)
+#define UNSWMPPTNG_OUT_GAIN_SCHEDULE       (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 18)
+#define UNSWMPPTNG_FEEDFORWARD             (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 22)
+#define UNSWMPPTNG_FEEDFORWARD_GAIN        (UNSWMPPTNG_IVSWEEP_STEP_SIZE + 23)
+#endif
+
+/* Channels and commands added since, likewise */ 
+#ifndef UNSWMPPTNG_SWEEP_POINT
+#define UNSWMPPTNG_SWEEP_POINT             (UNSWMPPTNG_SWEEP_IN_CURRENT + 1)
+#define UNSWMPPTNG_SWEEP_NUM_POINTS        (UNSWMPPTNG_SWEEP_IN_CURRENT + 2)
+#define UNSWMPPTNG_SWEEP_START_TIME        (UNSWMPPTNG_SWEEP_IN_CURRENT + 3)
+#define UNSWMPPTNG_SWEEP_STEP_SIZE         (UNSWMPPTNG_SWEEP_IN_CURRENT + 4)
+#define UNSWMPPTNG_SWEEP_TEMPERATURE       (UNSWMPPTNG_SWEEP_IN_CURRENT + 5)
+#define UNSWMPPTNG_PACKED_TELEM_0          (UNSWMPPTNG_SWEEP_IN_CURRENT + 6)
+#define UNSWMPPTNG_PACKED_TELEM_1          (UNSWMPPTNG_SWEEP_IN_CURRENT + 7)
+#define UNSWMPPTNG_SCOPE_INFO              (UNSWMPPTNG_SWEEP_IN_CURRENT + 8)
+#define UNSWMPPTNG_SCOPE_DATA              (UNSWMPPTNG_SWEEP_IN_CURRENT + 9)
+#define UNSWMPPTNG_ISR_STATS               (UNSWMPPTNG_SWEEP_IN_CURRENT + 10)
+#define UNSWMPPTNG_FPGA_STATUS             (UNSWMPPTNG_SWEEP_IN_CURRENT + 11)
+#define UNSWMPPTNG_FPGA_APPLIED            (UNSWMPPTNG_SWEEP_IN_CURRENT + 12)
+#define UNSWMPPTNG_TUNE_KU                 (UNSWMPPTNG_SWEEP_IN_CURRENT + 13)
+#define UNSWMPPTNG_TUNE_TU                 (UNSWMPPTNG_SWEEP_IN_CURRENT + 14)
+#define UNSWMPPTNG_TUNE_KP                 (UNSWMPPTNG_SWEEP_IN_CURRENT + 15)
+#define UNSWMPPTNG_TUNE_KI                 (UNSWMPPTNG_SWEEP_IN_CURRENT + 16)
+#define UNSWMPPTNG_TUNE_KD                 (UNSWMPPTNG_SWEEP_IN_CURRENT + 17)
+
+#define UNSWMPPTNG_COMMAND_IVSWEEP_SEND    (UNSWMPPTNG_COMMAND_SET_AND_TUNE + 1)
+#define UNSWMPPTNG_COMMAND_SCOPE_ARM       (UNSWMPPTNG_COMMAND_SET_AND_TUNE + 2)
+#define UNSWMPPTNG_COMMAND_SCOPE_SEND      (UNSWMPPTNG_COMMAND_SET_AND_TUNE + 3)
+#define UNSWMPPTNG_COMMAND_ISR_STATS       (UNSWMPPTNG_COMMAND_SET_AND_TUNE + 4)
+#endif
+
+/* Telemetry modes */ 
+#define MPPTNG_TELEMETRY_CHANNELS  0    /* One scandal channel message per value */ 
+#define MPPTNG_TELEMETRY_PACKED    1    /* Two packed 8 byte frames, see below */ 
+
+/* Raw frames 
+   -- 
+   Frames whose 8 data bytes have a layout of their own, rather than a 
+   channel's value + time, go out as MPPTNG_RAW_TYPE messages, a type 
+   above those scandal defines, so that nothing decodes them as channel 
+   readings. The channel field of the identifier says which frame it is. 
+   The IDs come from mpptng_mk_raw_id(), with scandal/message.h. */ 
+#define MPPTNG_RAW_TYPE            16
+
+#define mpptng_mk_raw_id(priority, frame) \
+  (((u32)(priority) << PRI_OFFSET) | ((u32)MPPTNG_RAW_TYPE << TYPE_OFFSET) | \
+   ((u32)scandal_get_addr() << NODE_ADDR_OFFSET) | \
+   ((u32)(frame) << CHANNEL_NUM_OFFSET))
+
+/* Packed telemetry 
+   -- 
+   Sent instead of the channel messages when telemetry_mode is 
+   MPPTNG_TELEMETRY_PACKED, as raw frames UNSWMPPTNG_PACKED_TELEM_x. The 
+   8 data bytes hold big-endian fixed point fields. Fields saturate 
+   rather than wrap. 
+   PACKED_TELEM_0: Vin (u16, 10mV), Iin (u16, mA), Vout (u16, 10mV), 
+                   PWM output (u16, CPLD counts) 
+   PACKED_TELEM_1: Heatsink temp (s16, 0.01C), Ambient temp (s16, 0.01C), 
+                   15V rail (u16, mV), status (u8), algorithm (u8) */ 
+
+/* CPLD readback (see fpga.h) 
+   -- 
+   FPGA_STATUS:  cause << 24 | live << 16 | switching cycles (u16, wraps) 
+   FPGA_APPLIED: PWM << 16 | period, in CPLD counts, as the CPLD has them 
+   Both go out every telemetry period in channel mode. FPGA_STATUS also 
+   goes out, in either mode, as soon as a new shutdown cause is seen. */ 
 
 /* Absolute limits of the tracker */ 
 #define ABS_MAX_VOUT     170000
@@ -70,8 +158,24 @@
 #define DEFAULT_OPENLOOP_RATIO  800
 #define DEFAULT_OPENLOOP_RETRACK_PERIOD 10000
 #define DEFAULT_PANDO_INCREMENT VIN_TO_ADC(0.5)
-#define DEFAULT_IVSWEEP_STEP_SIZE 300
+#define DEFAULT_PANDO_UPDATE_PERIOD   90      /* ms between perturbations */ 
+#define DEFAULT_VSPANDO_MIN_STEP      VIN_TO_ADC(0.1)
+#define DEFAULT_VSPANDO_MAX_STEP      VIN_TO_ADC(3.0)
+#define DEFAULT_VSPANDO_GAIN          8       /* step = gain * |dP/dV| / 256 */ 
+#define DEFAULT_IVSWEEP_STEP_SIZE 500
 #define DEFAULT_IVSWEEP_SAMPLE_PERIOD 30
+#define DEFAULT_IVSWEEP_NUM_POINTS    128
+#define DEFAULT_GMPPT_SCAN_PERIOD     60000   /* ms between global scans */ 
+#define DEFAULT_GMPPT_SAMPLE_PERIOD   0       /* ms per scan point (0 = every pv_track tick) */ 
+#define DEFAULT_GMPPT_STEP_SIZE       2000    /* mV between scan points */ 
+#define DEFAULT_GMPPT_LOCAL_ALGORITHM MPPTNG_INCCOND
+#define DEFAULT_TELEMETRY_MODE        MPPTNG_TELEMETRY_CHANNELS
+#define DEFAULT_NUM_PHASES            1       /* Power boards fitted, see fpga.h */ 
+#define DEFAULT_PHASE_CURRENT         2500    /* mA per board before the next one switches */ 
+#define DEFAULT_GAIN_BAND_CURRENT     2000    /* mA per gain schedule band */ 
+#define DEFAULT_GAIN_SCHEDULE         GAIN_SCHEDULE_UNITY
+#define DEFAULT_FEEDFORWARD           0       /* Off */ 
+#define DEFAULT_FEEDFORWARD_GAIN      FEEDFORWARD_UNITY
  
 /* Frequency constants */ 
 #define CONTROL_FS       1160L
@@ -84,9 +188,11 @@
 
 /* Default settings */ 
 #define DEFAULT_PWM          0
+#define DEFAULT_PWM_FRAC     0
 #define DEFAULT_AUX_LENGTH   55
 #define DEFAULT_AUX_OVERLAP  8
 #define DEFAULT_DEADTIME     25
+#define DEFAULT_PHASE        0
 #define DEFAULT_RESTART      1300
 
 /* PWM constants */ 
@@ -114,7 +220,21 @@
 #define DEFAULT_AMBIENT_TEMP_B         0
 
 /* Other constants */ 
-#define OUTPUT_LOOP_CHANGEOVER_HYSTERESIS    2000     /* 2V */ 
+#define OUTPUT_LOOP_CHANGEOVER_HYSTERESIS    2        /* CPLD PWM counts between the loops -- control.c */ 
+#define PHASE_UPDATE_PERIOD                  100      /* ms between looks at the phase count */ 
+#define PHASE_SHED_HYSTERESIS                4        /* Shed a board a 1/4 of phase_current late */ 
+
+/* Gain schedule: the loop gains are scaled by a factor per band of input 
+   current, in 1/GAIN_SCHEDULE_UNITY, with bands gain_band_current wide. 
+   The top band is open ended. */ 
+#define GAIN_SCHEDULE_BANDS                  4        /* See UNSWMPPTNG_OUT_GAIN_SCHEDULE */ 
+#define GAIN_SCHEDULE_SHIFT                  6
+#define GAIN_SCHEDULE_UNITY                  (1 << GAIN_SCHEDULE_SHIFT)
+#define GAIN_SCHEDULE_HYSTERESIS             8        /* Drop a band 1/8 of a band late */ 
+
+/* Duty feed-forward gain, in 1/FEEDFORWARD_UNITY */ 
+#define FEEDFORWARD_SHIFT                    6
+#define FEEDFORWARD_UNITY                    (1 << FEEDFORWARD_SHIFT)
 
 /* Rough limits defined in terms of the default scaling values */ 
 #define ADC_ABS_MAX_VOUT			VOUT_TO_ADC(ABS_MAX_VOUT / 1000.0)
@@ -122,7 +242,6 @@
 #define ADC_ABS_MAX_VIN				VIN_TO_ADC(ABS_MAX_VIN / 1000.0)
 #define ADC_ABS_MIN_15V				2000 /* 12.0V  -- NOT CORRECT, NEEDS UPDATE */
 #define ADC_ABS_MAX_HS_TEMP			3000 /* 100 Degrees -- NOT CORRECT, NEEDS UPDATE */
-#define ADC_OUTPUT_LOOP_CHANGEOVER_HYSTERESIS   100     /* 2V -- NOT CORRECT, NEEDS UPDATE */ 
 
 
 typedef struct mpptng_config{
@@ -137,14 +256,35 @@ typedef struct mpptng_config{
   /* PV tracking parameters */ 
   uint16_t openloop_ratio; 
   uint16_t pando_increment; 
+  uint16_t pando_update_period;  /* pv_track counts */ 
+  uint16_t vspando_min_step;     /* ADC counts */ 
+  uint16_t vspando_max_step;     /* ADC counts */ 
+  uint16_t vspando_gain; 
   uint16_t openloop_retrack_period; 
   uint16_t ivsweep_sample_period; 
   uint16_t ivsweep_step_size; 
-  
-  /* Checksums */ 
-  uint8_t magic; 
-  uint8_t checksum; 
-  uint8_t checkxor; 
+  uint16_t ivsweep_num_points;   /* <= IVSWEEP_MAX_POINTS */ 
+
+  /* Global MPPT parameters */ 
+  uint16_t gmppt_scan_period;    /* pv_track counts */ 
+  uint16_t gmppt_sample_period;  /* pv_track counts */ 
+  uint16_t gmppt_step_size;      /* mV */ 
+  uint8_t  gmppt_local_algorithm; 
+
+  uint8_t  telemetry_mode;       /* MPPTNG_TELEMETRY_x */ 
+
+  /* Interleaved power boards */ 
+  uint8_t  num_phases;           /* Boards fitted, 1 to FPGA_NUM_BOARDS */ 
+  uint16_t phase_current;        /* mA per board switching */ 
+
+  /* Gain schedule, by input current */ 
+  uint16_t gain_band_current;    /* mA per band */ 
+  uint8_t  in_gain_schedule[GAIN_SCHEDULE_BANDS];   /* 1/GAIN_SCHEDULE_UNITY */ 
+  uint8_t  out_gain_schedule[GAIN_SCHEDULE_BANDS];  /* 1/GAIN_SCHEDULE_UNITY */ 
+
+  /* Input loop duty feed-forward */ 
+  uint8_t  feedforward;          /* On if non-zero */ 
+  uint8_t  feedforward_gain;     /* 1/FEEDFORWARD_UNITY */ 
 }mpptng_config_t; 
 
 extern volatile mpptng_config_t config; 
@@ -11,6 +11,14 @@
 #define PV_HZ                    32L
 
 #define PVTRACK_PERIOD_TO_COUNT(x) ((((int32_t)x) * PV_HZ) / 1000L)
+/* Periods in ms the config takes: the shortest that is at least one 
+   count, and the longest a uint16_t count holds */ 
+#define PVTRACK_MIN_PERIOD       ((1000L + PV_HZ - 1) / PV_HZ)
+#define PVTRACK_MAX_PERIOD       ((0xFFFFL * 1000L) / PV_HZ)
+
+/* Hold off pv_track() (the Timer B compare interrupt) */ 
+#define PVTRACK_INTERRUPT_DISABLE() (TBCCTL0 &= ~CCIE)
+#define PVTRACK_INTERRUPT_ENABLE()  (TBCCTL0 |= CCIE)
 
 /* Open loop algorithm */ 
 #define OL_RETRACK_PERIOD        10000    /* Re-tracking period in ms - should be configurable? */     
@@ -22,20 +30,60 @@
 #define OL_CONVERTING            1
 
 /* PandO algorithm */ 
-#define PANDO_UPDATE_COUNT       2
 #define PANDO_SAMPLE_PERIOD      100
 #define PANDO_SAMPLE_COUNT       ((PANDO_SAMPLE_PERIOD * PV_HZ) / 1000L)
 
 #define PANDO_SAMPLING           0
 #define PANDO_TRACKING           1
 
+/* Variable step P and O */ 
+#define VSPANDO_GAIN_SHIFT       8
+
+/* Incremental conductance algorithm */ 
+#define INCCOND_UPDATE_COUNT     2
+#define INCCOND_MIN_DV           1    /* ADC counts -- smaller changes are treated as dV = 0 */ 
+#define INCCOND_MIN_DI           1    /* ADC counts -- smaller changes are treated as dI = 0 */ 
+#define INCCOND_TOLERANCE_SHIFT  3    /* Hold when |dP/dV| < I / 2^shift */ 
+
+#define INCCOND_SAMPLING         0
+#define INCCOND_TRACKING         1
+
+
+/* Global MPPT algorithm */ 
+#define GMPPT_PHASE_SETTLE       0
+#define GMPPT_PHASE_SCAN         1
+#define GMPPT_PHASE_TRACK        2
+#define GMPPT_SETTLE_COUNT       4    /* pv_track counts at open circuit before a scan */ 
+#define GMPPT_MAX_POINTS         128  /* A scan ends here even if it's still above min_vin */ 
+#define GMPPT_MIN_STEP_SIZE      ((ABS_MAX_VIN + GMPPT_MAX_POINTS - 1) / GMPPT_MAX_POINTS) /* mV, so the points reach 0V */ 
 
 /* IV SWEET algorithm */ 
 #define IVSWEEP_PHASE_SETTLE     0
 #define IVSWEEP_PHASE_SWEEP      1
-#define IVSWEEP_SETTLE_MS        1000
+#define IVSWEEP_SETTLE_MS        250
+
+/* The sweep is captured into RAM as packed 12 bit V/I pairs and sent 
+   afterwards on UNSWMPPTNG_COMMAND_IVSWEEP_SEND. The points go out two 
+   to a raw frame (see mpptng.h) on UNSWMPPTNG_SWEEP_POINT: the index of 
+   the first (u16, big-endian), then each point's 3 bytes as stored. 
+   The second point of the last frame of an odd sweep is zero. */ 
+#define IVSWEEP_MAX_POINTS       128
+#define IVSWEEP_POINT_BYTES      3
+#define IVSWEEP_FRAME_POINTS     2
+#define IVSWEEP_SEND_BURST       8    /* Messages per pass of the main loop */ 
+
+#define IVSWEEP_BUF_EMPTY        0
+#define IVSWEEP_BUF_CAPTURING    1
+#define IVSWEEP_BUF_READY        2
+#define IVSWEEP_BUF_SENDING      3
+
+/* Input voltage and current averaged over the last pv_track period, raw */ 
+extern int32_t vin_raw; 
+extern int32_t iin_raw; 
+extern volatile int pv_algorithm; 
 
 void pv_track_init(void); 
 void pv_track_switchto(int algorithm);
 void pv_track_send_data(void);
+int  pv_track_ivsweep_send(void);
 void pv_track_send_telemetry(void);
@@ -0,0 +1,150 @@
+/* Copyright (C) agent, 2026 */
+
+/*
+ * This file is part of the UNSWMPPTNG firmware.
+ *
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Triggered capture of the control loop at CONTROL_FS
+   --
+   Armed with UNSWMPPTNG_COMMAND_SCOPE_ARM:
+     data[0]    trigger mask (SCOPE_TRIG_x, 0 triggers straight away)
+     data[1]    samples to keep from before the trigger
+     data[2]    record every nth ADC sequence (0 or 1 for every one)
+     data[3]    level trigger channel (SCOPE_CH_x), | SCOPE_LEVEL_RISING
+     data[4..5] level trigger threshold, raw ADC counts, big-endian
+   Read out with UNSWMPPTNG_COMMAND_SCOPE_SEND once the capture is done:
+   one UNSWMPPTNG_SCOPE_INFO channel message (cause << 16 |
+   pre-trigger samples << 8 | decimation), then SCOPE_DEPTH frames on
+   UNSWMPPTNG_SCOPE_DATA, oldest first, each holding the big-endian
+   words below. The sample index is split across the top nibbles of
+   vout (high) and iin (low). */
+
+#ifndef __SCOPE__
+#define __SCOPE__
+
+#define SCOPE_DEPTH           48   /* 8 bytes of RAM each */
+#define SCOPE_SEND_BURST      8    /* Messages per pass of the main loop */
+
+/* Trigger causes */
+#define SCOPE_TRIG_NOW        0x00
+#define SCOPE_TRIG_TARGET     0x01 /* Input loop target changed */
+#define SCOPE_TRIG_CHANGEOVER 0x02 /* Input/output loop changeover */
+#define SCOPE_TRIG_PANIC      0x04 /* tracker_panic() */
+#define SCOPE_TRIG_LEVEL      0x08 /* Threshold crossing */
+
+/* Level trigger channels */
+#define SCOPE_CH_VIN          0
+#define SCOPE_CH_VOUT         1
+#define SCOPE_CH_IIN          2
+#define SCOPE_LEVEL_RISING    0x80
+
+#define SCOPE_IDLE            0
+#define SCOPE_ARMED           1
+#define SCOPE_TRIGGERED       2
+#define SCOPE_DONE            3
+#define SCOPE_SENDING         4
+
+#define SCOPE_LOOP_FLAG       0x8000 /* In vin: output loop active */
+
+typedef struct scope_sample_t {
+  uint16_t vin;   /* | SCOPE_LOOP_FLAG */
+  uint16_t vout;
+  uint16_t iin;
+  uint16_t output;
+} scope_sample_t;
+
+typedef struct scope_state_t {
+  uint8_t  state;         /* SCOPE_x */
+  uint8_t  mask;          /* Enabled triggers */
+  uint8_t  cause;         /* What fired */
+  uint8_t  pre;           /* Samples before the trigger */
+  uint8_t  decimation;
+  uint8_t  decimate_count;
+  uint8_t  index;         /* Next sample to write */
+  uint8_t  filled;        /* Samples written since arming, up to SCOPE_DEPTH */
+  uint8_t  remaining;     /* Samples still to write after the trigger */
+  uint8_t  level_channel;
+  uint16_t level;
+  uint16_t last_level;    /* Previous sample of the level channel */
+  uint8_t  send_index;
+} scope_state_t;
+
+extern volatile scope_state_t  scope;
+extern volatile scope_sample_t scope_buf[SCOPE_DEPTH];
+
+void scope_arm(u08* data);
+int  scope_send(void);
+void scope_send_data(void);
+
+/* Called with the ADC interrupt disabled, or from the ADC ISR */
+static inline void scope_trigger(uint8_t cause){
+  if(scope.state == SCOPE_ARMED && (scope.mask & cause)){
+    scope.state = SCOPE_TRIGGERED;
+    scope.cause = cause;
+    if(scope.filled < scope.pre)
+      scope.pre = scope.filled;
+    scope.remaining = SCOPE_DEPTH - scope.pre;
+  }
+}
+
+/* Called from the ADC ISR with every sequence. Returns straight away
+   unless the scope is armed or triggered. */
+static inline void scope_record(uint16_t vin, uint16_t vout,
+				uint16_t iin, uint16_t output){
+  volatile scope_sample_t* p;
+
+  if(scope.state != SCOPE_ARMED && scope.state != SCOPE_TRIGGERED)
+    return;
+
+  if(--scope.decimate_count != 0)
+    return;
+  scope.decimate_count = scope.decimation;
+
+  p = &scope_buf[scope.index];
+  p->vin = vin;
+  p->vout = vout;
+  p->iin = iin;
+  p->output = output;
+
+  if(++scope.index >= SCOPE_DEPTH)
+    scope.index = 0;
+
+  if(scope.state == SCOPE_TRIGGERED){
+    if(--scope.remaining == 0)
+      scope.state = SCOPE_DONE;
+    return;
+  }
+
+  if(scope.filled < SCOPE_DEPTH)
+    scope.filled++;
+
+  if(scope.mask & SCOPE_TRIG_LEVEL){
+    uint16_t value = (scope.level_channel & ~SCOPE_LEVEL_RISING) == SCOPE_CH_VOUT ? vout :
+      (scope.level_channel & ~SCOPE_LEVEL_RISING) == SCOPE_CH_IIN ? iin :
+      (vin & ~SCOPE_LOOP_FLAG);
+
+    if(scope.level_channel & SCOPE_LEVEL_RISING){
+      if(scope.last_level < scope.level && value >= scope.level)
+	scope_trigger(SCOPE_TRIG_LEVEL);
+    }else{
+      if(scope.last_level > scope.level && value <= scope.level)
+	scope_trigger(SCOPE_TRIG_LEVEL);
+    }
+    scope.last_level = value;
+  }
+}
+
+#endif
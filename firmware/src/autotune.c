@@ -0,0 +1,167 @@
+/* Copyright (C) agent, 2026 */
+
+/*
+ * This file is part of the UNSWMPPTNG firmware.
+ *
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Relay auto-tuner -- starting, timing out and working out the gains.
+   The relay itself is autotune_relay() in autotune.h, run from the ADC ISR. */
+
+#include <io.h>
+#include <signal.h>
+
+#include <scandal/engine.h>
+#include <scandal/message.h>
+#include <scandal/timer.h>
+#include <scandal/devices.h>
+
+#include <arch/adc.h>
+
+#include <project/hardware.h>
+#include <project/mpptng.h>
+#include <project/control.h>
+#include <project/config.h>
+#include <project/pv_track.h>
+#include <project/autotune.h>
+
+volatile autotune_state_t autotune;
+
+void autotune_start(u08* data){
+  int32_t value;
+
+  value = ((uint32_t)data[0]) << 24 |
+    ((uint32_t)data[1]) << 16 |
+    ((uint32_t)data[2]) << 8 |
+    ((uint32_t)data[3]) << 0 ;
+
+  /* Hold the target still for the experiment */
+  pv_track_switchto(MPPTNG_MANUAL);
+  control_set_voltage(value);
+
+  autotune.flags = data[4];
+  autotune.relay = PWM_TO_OUTPUT(data[5] ? data[5] : AUTOTUNE_DEFAULT_RELAY);
+  autotune.started = sc_get_timer();
+  autotune.state = AUTOTUNE_SETTLE;
+}
+
+/* Put the tracker back as it was, and send Ku = 0 if we didn't get
+   any gains */
+static void
+autotune_finish(int ok){
+  ADC_INTERRUPT_DISABLE();
+  if(autotune.state == AUTOTUNE_RELAY || autotune.state == AUTOTUNE_DONE)
+    control_resume_input_loop(autotune.bias);
+  autotune.state = AUTOTUNE_IDLE;
+  ADC_INTERRUPT_ENABLE();
+
+  if(config.algorithm != MPPTNG_MANUAL)
+    pv_track_switchto(config.algorithm);
+
+  if(!ok){
+    scandal_send_channel(TELEM_LOW, UNSWMPPTNG_TUNE_KU, 0);
+    scandal_send_channel(TELEM_LOW, UNSWMPPTNG_TUNE_TU, 0);
+  }
+}
+
+/* Ku = 4 * relay / (pi * a), a being half the mean peak to peak, and
+   pi taken as 355/113. Tyreus-Luyben PI gains from there, rather than
+   Ziegler-Nichols, Kc = Ku / 3.2 and Ti = 2.2 Tu, so Ki = Kc / Ti with
+   Ti in ADC sequences. The loop's ultimate period is only a couple of
+   ADC sequences: Ziegler-Nichols gains ring, and there is no room for
+   a derivative term, so Kd is left at 0. */
+static void
+autotune_gains(void){
+  pid_const_t gains;
+  int32_t ku, tu;
+  uint16_t period = autotune.period_sum;
+  uint16_t amplitude = autotune.amplitude_sum;
+
+  if(amplitude < AUTOTUNE_MIN_AMPLITUDE * AUTOTUNE_CYCLES || period == 0){
+    autotune_finish(0);
+    return;
+  }
+
+  ku = (autotune.relay * (8 * AUTOTUNE_CYCLES)) / amplitude;
+  ku = (ku * 113) / 355;
+  tu = ((int32_t)period * (1000000L / CONTROL_FS)) / AUTOTUNE_CYCLES;
+
+  gains.Kp = (ku * 5) / 16;
+  gains.Ki = (gains.Kp * (5 * AUTOTUNE_CYCLES)) / (11L * period);
+  gains.Kd = 0;
+
+  scandal_send_channel(TELEM_LOW, UNSWMPPTNG_TUNE_KU, ku);
+  scandal_send_channel(TELEM_LOW, UNSWMPPTNG_TUNE_TU, tu);
+  scandal_send_channel(TELEM_LOW, UNSWMPPTNG_TUNE_KP, gains.Kp);
+  scandal_send_channel(TELEM_LOW, UNSWMPPTNG_TUNE_KI, gains.Ki);
+  scandal_send_channel(TELEM_LOW, UNSWMPPTNG_TUNE_KD, gains.Kd);
+
+  /* Hand over to the new gains at the output the relay was about */
+  if(autotune.flags & AUTOTUNE_COMMIT){
+    control_store_in_gains(&gains);
+    config_changed();
+  }
+
+  autotune_finish(1);
+}
+
+/* Called from the main loop */
+void autotune_poll(void){
+  sc_time_t now;
+
+  if(autotune.state == AUTOTUNE_IDLE)
+    return;
+
+  /* A panic or a restart ends the experiment */
+  if((tracker_status & STATUS_TRACKING) == 0){
+    autotune_finish(0);
+    return;
+  }
+
+  now = sc_get_timer();
+
+  switch(autotune.state){
+  case AUTOTUNE_SETTLE:
+    if(now < autotune.started + AUTOTUNE_SETTLE_TIME)
+      break;
+
+    ADC_INTERRUPT_DISABLE();
+    autotune.bias = in_pid_data.uk_1;
+    if(autotune.bias < OUT_MIN + autotune.relay)
+      autotune.bias = OUT_MIN + autotune.relay;
+    else if(autotune.bias > OUT_MAX - autotune.relay)
+      autotune.bias = OUT_MAX - autotune.relay;
+    autotune.high = 0;
+    autotune.cycles = 0;
+    autotune.samples = 0;
+    autotune.last_switch = 0;
+    autotune.period_sum = 0;
+    autotune.amplitude_sum = 0;
+    autotune.emax = autotune.emin = 0;
+    autotune.started = now;
+    autotune.state = AUTOTUNE_RELAY;
+    ADC_INTERRUPT_ENABLE();
+    break;
+
+  case AUTOTUNE_RELAY:
+    if(now >= autotune.started + AUTOTUNE_TIMEOUT)
+      autotune_finish(0);
+    break;
+
+  case AUTOTUNE_DONE:
+    autotune_gains();
+    break;
+  }
+}
@@ -0,0 +1,154 @@
+/* Copyright (C) agent, 2026 */
+
+/*
+ * This file is part of the UNSWMPPTNG firmware.
+ *
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Calibration cache -- building it from scandal's m and b.
+   The conversions themselves are inline, in calibration.h. */
+
+#include <io.h>
+#include <signal.h>
+
+#include <scandal/engine.h>
+#include <scandal/adc.h>
+
+#include <project/mpptng.h>
+#include <project/control.h>
+#include <project/pv_track.h>
+#include <project/hardware.h>
+#include <project/fpga.h>
+#include <project/calibration.h>
+
+#define CAL_LIMIT   (1L << 30)   /* Keep a bit of headroom in 32 bits */
+
+volatile calibration_t calibration[CAL_NUM_CHANNELS];
+volatile calibration_recip_t calibration_recip;
+
+static const uint16_t cal_channel[CAL_NUM_CHANNELS] = {
+  [CAL_VIN]  = UNSWMPPTNG_IN_VOLTAGE,
+  [CAL_IIN]  = UNSWMPPTNG_IN_CURRENT,
+  [CAL_VOUT] = UNSWMPPTNG_OUT_VOLTAGE,
+};
+
+/* Rounded to nearest, either sign */
+static int64_t
+div_round(int64_t n, int64_t d){
+  if(d < 0){
+    n = -n;
+    d = -d;
+  }
+  return (n >= 0 ? n + d / 2 : n - d / 2) / d;
+}
+
+/* Only ever run from the main loop, so the divides here are fine */
+static void
+calibration_build(calibration_t* cal, int32_t m, int32_t b){
+  int64_t am = m < 0 ? -(int64_t)m : m;
+  int64_t ab = b < 0 ? -(int64_t)b : b;
+  int64_t full;
+  uint8_t s;
+
+  cal->m = m;
+  cal->b = b;
+
+  /* The largest scaled value a reading could give */
+  full = (CAL_ADC_FULL_SCALE * am + ab) / 1000 + 1;
+
+  for(s = CAL_MAX_SHIFT; s > 0 && (full << s) >= CAL_LIMIT; s--)
+    ;
+  cal->scale_shift = s;
+  cal->scale_mul = div_round((int64_t)m << s, 1000);
+  cal->scale_add = div_round((int64_t)b << s, 1000) + ((1L << s) >> 1);
+
+  cal->unscale_off = div_round(b, 1000);
+
+  /* As scandal, leave the value alone if there's no m */
+  if(m == 0){
+    cal->unscale_max = CAL_LIMIT;
+    cal->unscale_mul = 1;
+    cal->unscale_shift = 0;
+    cal->unscale_round = 0;
+    return;
+  }
+
+  cal->unscale_max = (CAL_ADC_FULL_SCALE * am) / 1000 + 1;
+  for(s = CAL_MAX_SHIFT; s > 0 &&
+	cal->unscale_max * div_round(1000LL << s, am) >= CAL_LIMIT; s--)
+    ;
+  cal->unscale_shift = s;
+  cal->unscale_mul = div_round(1000LL << s, m);
+  cal->unscale_round = (1L << s) >> 1;
+}
+
+/* Build the cache from scandal's m and b. The Timer B interrupt (which
+   runs pv_track) is held off while each channel is copied in, if it's
+   running yet. */
+void calibration_update(void){
+  calibration_t cal;
+  uint16_t ie = TBCCTL0 & CCIE;
+  uint8_t c;
+
+  for(c=0; c<CAL_NUM_CHANNELS; c++){
+    calibration_build(&cal, scandal_get_m(cal_channel[c]),
+		      scandal_get_b(cal_channel[c]));
+
+    PVTRACK_INTERRUPT_DISABLE();
+    calibration[c] = cal;
+    TBCCTL0 |= ie;
+  }
+}
+
+/* Take the reciprocal of the filtered Vout, against the PWM period
+   board 1 is programmed with. Vout moves slowly next to the main loop,
+   so this is as fresh as the feed-forward needs. */
+static void
+calibration_update_recip(void){
+  calibration_recip_t recip;
+  uint16_t ie = TBCCTL0 & CCIE;
+
+  recip.vout = calibration_scale(CAL_VOUT, sample_adc(MEAS_VOUT));
+  recip.period = fpga_spi.value[0][SIGNAL_RESTART];
+  if(recip.vout >= CAL_RECIP_MIN_VOUT)
+    recip.per_mv = ((int32_t)recip.period << CAL_RECIP_SHIFT) / recip.vout;
+  else
+    recip.per_mv = 0;
+
+  PVTRACK_INTERRUPT_DISABLE();
+  calibration_recip = recip;
+  TBCCTL0 |= ie;
+}
+
+/* Called from the main loop. scandal takes new m and b itself, so look
+   for a change, and take it up in the cache, the control loop's limits
+   and the gain schedule's band edges. */
+void calibration_poll(void){
+  uint8_t c;
+
+  calibration_update_recip();
+
+  for(c=0; c<CAL_NUM_CHANNELS; c++)
+    if(scandal_get_m(cal_channel[c]) != calibration[c].m ||
+       scandal_get_b(cal_channel[c]) != calibration[c].b)
+      break;
+
+  if(c == CAL_NUM_CHANNELS)
+    return;
+
+  calibration_update();
+  update_control_maxmin();
+  control_update_gains();
+}
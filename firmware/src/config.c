@@ -19,7 +19,14 @@
 
 /* config.c 
  * David Snowdon, 28 March, 2008
+ *
+ * The config is journalled rather than rewritten in place: every write 
+ * appends a record, with a sequence number and a CRC, to the next slot 
+ * in the user EEPROM. The newest record with a good CRC is the config, 
+ * so a write cut short by a power loss leaves the one before it. 
  */
+#include <stddef.h>
+
 #include <io.h>
 #include <signal.h>
 #include <iomacros.h>
@@ -27,57 +34,273 @@
 #include <scandal/devices.h>
 #include <scandal/eeprom.h>
 #include <scandal/types.h>
+#include <scandal/timer.h>
 
 #include <project/mpptng_error.h>
+#include <project/pv_track.h>
 #include <project/config.h>
 
-/* Magic number to make sure EEPROM has been programmed */ 
+/* Marks a slot that has been written */ 
 #define MPPTNG_CONFIG_MAGIC 0xAA
 
-static inline void
-calculate_checksum(mpptng_config_t config, uint8_t *sum, uint8_t *xor){
-    uint8_t* array; 
-    uint16_t i; 
-    
-    *sum = *xor = 0;
-    array = (uint8_t*)(&config); 
-    for(i=0; i<sizeof(config); i++){
-        *sum += *array; 
-        *xor ^= *array; 
-        array++; 
+typedef struct config_header{
+  uint8_t  magic; 
+  uint8_t  version;              /* CONFIG_VERSION */ 
+  uint16_t seq;                  /* Incremented on every write */ 
+  uint16_t length;               /* sizeof(mpptng_config_t) */ 
+}config_header_t; 
+
+/* A record is the header, the config and a CRC over both */ 
+typedef struct config_record{
+  config_header_t header; 
+  mpptng_config_t config; 
+  uint16_t        crc; 
+}config_record_t; 
+
+/* The config as the firmware before the journal kept it: one block at 
+   address 0, where slot 0 now is, with a byte sum and xor over it */ 
+typedef struct config_legacy{
+  int32_t  max_vout; 
+  int32_t  min_vin; 
+  uint8_t  algorithm; 
+  pid_const_t in_pid_const; 
+  pid_const_t out_pid_const; 
+  uint16_t openloop_ratio; 
+  uint16_t pando_increment; 
+  uint16_t openloop_retrack_period; 
+  uint16_t ivsweep_sample_period; 
+  uint16_t ivsweep_step_size; 
+  uint8_t  magic;                /* Never set */ 
+  uint8_t  checksum; 
+  uint8_t  checkxor; 
+}config_legacy_t; 
+
+/* Records never straddle a segment */ 
+#define CONFIG_SLOTS_PER_SEGMENT   (CONFIG_SEGMENT_SIZE / sizeof(config_record_t))
+#define CONFIG_SLOTS               (CONFIG_SLOTS_PER_SEGMENT * \
+                                    (CONFIG_JOURNAL_SIZE / CONFIG_SEGMENT_SIZE))
+#define CONFIG_SLOT_ADDR(s)        (((s) / CONFIG_SLOTS_PER_SEGMENT) * CONFIG_SEGMENT_SIZE + \
+                                    ((s) % CONFIG_SLOTS_PER_SEGMENT) * sizeof(config_record_t))
+
+/* At least one slot in each segment, or a torn write can lose the lot. 
+   config_read() keeps a bit per slot, and the EEPROM calls take a u08 
+   length. */ 
+typedef char config_journal_fits[(CONFIG_SLOTS_PER_SEGMENT >= 1 && CONFIG_SLOTS <= 8 && 
+                                  sizeof(config_record_t) <= 255) ? 1 : -1]; 
+
+/* Where the newest record is, and its sequence number */ 
+static uint8_t  config_slot = CONFIG_SLOTS - 1; 
+static uint16_t config_seq; 
+
+/* Set by config_changed(), until the change is written */ 
+static uint8_t   config_dirty; 
+static sc_time_t config_changed_time; 
+
+/* CRC-16-CCITT, polynomial 0x1021, bit at a time. Only run on a read or 
+   write of the config, so a table isn't worth the flash. */ 
+static uint16_t
+crc16(uint16_t crc, const uint8_t* data, uint16_t length){
+  uint8_t i; 
+
+  while(length--){
+    crc ^= (uint16_t)(*data++) << 8; 
+    for(i=0; i<8; i++){
+      if(crc & 0x8000)
+        crc = (crc << 1) ^ 0x1021; 
+      else
+        crc <<= 1; 
     }
+  }
+  return crc; 
+}
+
+static uint16_t
+config_crc(const config_header_t* header, const mpptng_config_t* data){
+  uint16_t crc = 0xFFFF; 
+
+  crc = crc16(crc, (const uint8_t*)header, sizeof(*header)); 
+  return crc16(crc, (const uint8_t*)data, sizeof(*data)); 
+}
+
+/* True if sequence number a was written after b */ 
+static inline int
+seq_after(uint16_t a, uint16_t b){
+  return (int16_t)(a - b) > 0; 
 }
 
 void
-config_read(void){
-  uint8_t sum, xor; 
+config_defaults(void){
+  uint8_t i; 
+
+  config.max_vout = DEFAULT_MAX_VOUT; 
+  config.min_vin = DEFAULT_MIN_VIN;
+  config.algorithm = DEFAULT_ALGORITHM; 
+  config.in_pid_const.Kp = DEFAULT_IN_KP; 
+  config.in_pid_const.Ki = DEFAULT_IN_KI; 
+  config.in_pid_const.Kd = DEFAULT_IN_KD; 
+  config.out_pid_const.Kp = DEFAULT_OUT_KP; 
+  config.out_pid_const.Ki = DEFAULT_OUT_KI; 
+  config.out_pid_const.Kd = DEFAULT_OUT_KD;
+ 
+  config.openloop_ratio = DEFAULT_OPENLOOP_RATIO; 
+  config.openloop_retrack_period = 
+    PVTRACK_PERIOD_TO_COUNT(DEFAULT_OPENLOOP_RETRACK_PERIOD); 
+  config.pando_increment = DEFAULT_PANDO_INCREMENT; 
+  config.pando_update_period = 
+    PVTRACK_PERIOD_TO_COUNT(DEFAULT_PANDO_UPDATE_PERIOD); 
+  config.vspando_min_step = DEFAULT_VSPANDO_MIN_STEP; 
+  config.vspando_max_step = DEFAULT_VSPANDO_MAX_STEP; 
+  config.vspando_gain = DEFAULT_VSPANDO_GAIN; 
+  config.ivsweep_step_size = DEFAULT_IVSWEEP_STEP_SIZE; 
+  config.ivsweep_sample_period = 
+    PVTRACK_PERIOD_TO_COUNT(DEFAULT_IVSWEEP_SAMPLE_PERIOD); 
+  config.ivsweep_num_points = DEFAULT_IVSWEEP_NUM_POINTS; 
+  config.telemetry_mode = DEFAULT_TELEMETRY_MODE; 
+  config.gmppt_scan_period = 
+    PVTRACK_PERIOD_TO_COUNT(DEFAULT_GMPPT_SCAN_PERIOD); 
+  config.gmppt_sample_period = 
+    PVTRACK_PERIOD_TO_COUNT(DEFAULT_GMPPT_SAMPLE_PERIOD); 
+  config.gmppt_step_size = DEFAULT_GMPPT_STEP_SIZE; 
+  config.gmppt_local_algorithm = DEFAULT_GMPPT_LOCAL_ALGORITHM; 
+  config.num_phases = DEFAULT_NUM_PHASES; 
+  config.phase_current = DEFAULT_PHASE_CURRENT; 
+  config.gain_band_current = DEFAULT_GAIN_BAND_CURRENT; 
+  for(i=0; i<GAIN_SCHEDULE_BANDS; i++){
+    config.in_gain_schedule[i] = DEFAULT_GAIN_SCHEDULE; 
+    config.out_gain_schedule[i] = DEFAULT_GAIN_SCHEDULE; 
+  }
+  config.feedforward = DEFAULT_FEEDFORWARD; 
+  config.feedforward_gain = DEFAULT_FEEDFORWARD_GAIN; 
+}
+
+/* Take up the block the firmware before the journal left, over the 
+   defaults for everything it didn't have. Its checks pass on a block of 
+   zeros, so the voltages have to make sense as well. Returns 0 if there's 
+   no such block. */ 
+static int
+config_read_legacy(void){
+  config_legacy_t legacy; 
+  uint8_t* p = (uint8_t*)&legacy; 
+  uint8_t sum = 0, xor = 0; 
   uint8_t insum, inxor; 
+  uint8_t i; 
 
-  sc_user_eeprom_read_block(0, (uint8_t*)&config, sizeof(config)); 
-    
-  insum = config.checksum; 
-  inxor = config.checkxor; 
-    
-  config.checksum = config.checkxor = 0; 
+  sc_user_eeprom_read_block(0, (u08*)&legacy, sizeof(legacy)); 
 
-  calculate_checksum(config, &sum, &xor); 
+  insum = legacy.checksum; 
+  inxor = legacy.checkxor; 
+  legacy.checksum = legacy.checkxor = 0; 
+  for(i=0; i<sizeof(legacy); i++){
+    sum += p[i]; 
+    xor ^= p[i]; 
+  }
+
+  if(insum != sum || inxor != xor || 
+     legacy.max_vout <= 0 || legacy.max_vout > ABS_MAX_VOUT || 
+     legacy.min_vin <= 0 || legacy.min_vin > ABS_MAX_VIN)
+    return 0; 
+
+  config_defaults(); 
+  config.max_vout = legacy.max_vout; 
+  config.min_vin = legacy.min_vin; 
+  config.algorithm = legacy.algorithm; 
+  config.in_pid_const = legacy.in_pid_const; 
+  config.out_pid_const = legacy.out_pid_const; 
+  config.openloop_ratio = legacy.openloop_ratio; 
+  config.pando_increment = legacy.pando_increment; 
+  config.openloop_retrack_period = legacy.openloop_retrack_period; 
+  config.ivsweep_sample_period = legacy.ivsweep_sample_period; 
+  config.ivsweep_step_size = legacy.ivsweep_step_size; 
+  return 1; 
+}
 
-  if( (insum != sum) || (inxor != xor) ){
-    mpptng_fatal_error(UNSWMPPTNG_ERROR_EEPROM); 
+/* Read the slot headers, then try the records newest first, reading each 
+   straight into config. With no good record, a unit coming up from the 
+   firmware before the journal has its old block taken up; the write that 
+   follows lands in slot 0, over that block, so this only happens once. 
+   Otherwise it falls back to the defaults, and raises 
+   UNSWMPPTNG_ERROR_EEPROM, rather than stopping: an unconfigured node is 
+   better than a dead one. */ 
+void
+config_read(void){
+  config_header_t header[CONFIG_SLOTS]; 
+  uint8_t tried = 0; 
+  uint8_t s, newest; 
+  uint16_t crc; 
+
+  for(s=0; s<CONFIG_SLOTS; s++){
+    sc_user_eeprom_read_block(CONFIG_SLOT_ADDR(s), (u08*)&header[s], 
+                              sizeof(config_header_t)); 
+    if(header[s].magic != MPPTNG_CONFIG_MAGIC || 
+       header[s].version != CONFIG_VERSION || 
+       header[s].length != sizeof(mpptng_config_t))
+      tried |= 1 << s; 
   }
+
+  for(;;){
+    newest = CONFIG_SLOTS; 
+    for(s=0; s<CONFIG_SLOTS; s++){
+      if(tried & (1 << s))
+        continue; 
+      if(newest == CONFIG_SLOTS || seq_after(header[s].seq, header[newest].seq))
+        newest = s; 
+    }
+    if(newest == CONFIG_SLOTS)
+      break; 
+    tried |= 1 << newest; 
+
+    sc_user_eeprom_read_block(CONFIG_SLOT_ADDR(newest) + offsetof(config_record_t, config), 
+                              (u08*)&config, sizeof(mpptng_config_t)); 
+    sc_user_eeprom_read_block(CONFIG_SLOT_ADDR(newest) + offsetof(config_record_t, crc), 
+                              (u08*)&crc, sizeof(crc)); 
+
+    if(crc == config_crc(&header[newest], (const mpptng_config_t*)&config)){
+      config_slot = newest; 
+      config_seq = header[newest].seq; 
+      return; 
+    }
+  }
+
+  if(config_read_legacy()){
+    config_write(); 
+    return; 
+  }
+
+  mpptng_error(UNSWMPPTNG_ERROR_EEPROM); 
+  config_defaults(); 
+  config_write(); 
 }
 
+/* Append the config to the journal, in the slot after the newest record */ 
 int config_write(void){
-  uint8_t sum, xor; 
+  config_record_t record; 
 
-  config.checksum = config.checkxor = 0; 
-  
-  calculate_checksum(config, &sum, &xor); 
-  
-  config.checksum = sum; 
-  config.checkxor = xor; 
+  record.header.magic = MPPTNG_CONFIG_MAGIC; 
+  record.header.version = CONFIG_VERSION; 
+  record.header.seq = config_seq + 1; 
+  record.header.length = sizeof(mpptng_config_t); 
+  record.config = config; 
+  record.crc = config_crc(&record.header, &record.config); 
 
-  sc_user_eeprom_write_block(0, (u08*)&config, sizeof(config)); 
+  config_slot = (config_slot + 1) % CONFIG_SLOTS; 
+  config_seq = record.header.seq; 
+  config_dirty = 0; 
+
+  sc_user_eeprom_write_block(CONFIG_SLOT_ADDR(config_slot), (u08*)&record, 
+                             sizeof(record)); 
 
   return 0; 
 }
+
+/* Note a change to config, to be written by config_flush() */ 
+void config_changed(void){
+  config_dirty = 1; 
+  config_changed_time = sc_get_timer(); 
+}
+
+/* Called from the main loop: write config once it has been left alone 
+   for CONFIG_WRITE_DELAY */ 
+void config_flush(void){
+  if(config_dirty && sc_get_timer() >= config_changed_time + CONFIG_WRITE_DELAY)
+    config_write(); 
+}
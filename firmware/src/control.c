@@ -34,15 +34,16 @@
 #include <project/mpptng.h>
 #include <project/fpga.h>
 #include <project/mpptng_error.h>
+#include <project/scope.h>
+#include <project/isr_stats.h>
+#include <project/autotune.h>
+#include <project/calibration.h>
 
-#define OUTPUT_TO_PWM(x) (((int32_t)x) >> 14)
-#define PWM_TO_OUTPUT(x) (((int32_t)x) << 14)
+/* Keep some of the fraction for the CPLD to dither */ 
+#define OUTPUT_TO_FPGA(x) (((int32_t)x) >> (14 - FPGA_PWM_FRAC_BITS))
 #define INTEGRAL_DIVIDER_BITS 1
 #define DIFFERENTIAL_DIVIDER_BITS 10
 
-#define OUT_MAX PWM_TO_OUTPUT(PWM_MAX)
-#define OUT_MIN PWM_TO_OUTPUT(PWM_MIN)
-
 volatile int32_t target; /* target voltage mV */
 volatile int32_t output; /* current pwm output */
 volatile int32_t control_error; /* current pwn output */
@@ -52,9 +53,28 @@ volatile int     active_loop; /* Tracking on input or output */
 volatile pid_data_t in_pid_data;
 volatile pid_data_t out_pid_data;
 
+static uint8_t phases = 1;    /* Power boards switching */ 
+
+/* The loop gains in use, one set per gain schedule band: config's, 
+   scaled by the band's factor and divided by the number of boards 
+   switching, as each board adds as much again to the loop gain */ 
+static volatile pid_const_t in_pid_const[GAIN_SCHEDULE_BANDS]; 
+static volatile pid_const_t out_pid_const[GAIN_SCHEDULE_BANDS]; 
+
+/* Input current, in ADC counts, to go up from band b (gain_band_up[b]) 
+   and to come back down to it (gain_band_down[b]) */ 
+static volatile uint16_t gain_band_up[GAIN_SCHEDULE_BANDS - 1]; 
+static volatile uint16_t gain_band_down[GAIN_SCHEDULE_BANDS - 1]; 
+static volatile uint8_t  gain_band; 
+
 uint16_t min_vin_adc  = 0;    /* will be updated from the config */ 
 uint16_t max_vout_adc = 4095; /* will be updated from the config*/ 
 
+/* The absolute limits, by the calibration once update_control_maxmin() 
+   has run */ 
+static uint16_t abs_max_vout_adc = ADC_ABS_MAX_VOUT; 
+static uint16_t abs_min_vin_adc  = ADC_ABS_MIN_VIN; 
+
 /* Internal prototypes */ 
 static inline uint16_t read_adc_value(u08 channel);
 
@@ -67,10 +87,46 @@ static inline uint16_t read_adc_value(u08 channel);
  voltage or input current as low as possible. 
  ----------------------------------------------------------------*/
 
-static volatile uint16_t			samples[ADC_NUM_CHANNELS]; 
-
+/* IIR filter state, in units of 2^-ADC_FILTER_FRAC_BITS ADC counts */ 
+static volatile uint16_t filter_state[ADC_FILTER_MAX_ORDER][ADC_NUM_CHANNELS]; 
+
+/* Indexed by MEAS_x. Only ever indexed by constants in the ISR, so the 
+   compiler folds these into immediate shifts. */ 
+static const uint8_t filter_order[ADC_NUM_CHANNELS] = {
+  [MEAS_TAMBIENT]  = ADC_FILTER_ORDER_TAMBIENT, 
+  [MEAS_THEATSINK] = ADC_FILTER_ORDER_THEATSINK, 
+  [MEAS_15V]       = ADC_FILTER_ORDER_15V, 
+  [MEAS_VOUT]      = ADC_FILTER_ORDER_VOUT, 
+  [MEAS_IIN1]      = ADC_FILTER_ORDER_IIN1, 
+  [MEAS_VIN1]      = ADC_FILTER_ORDER_VIN1, 
+}; 
+
+static const uint8_t filter_shift[ADC_NUM_CHANNELS] = {
+  [MEAS_TAMBIENT]  = ADC_FILTER_SHIFT_TAMBIENT, 
+  [MEAS_THEATSINK] = ADC_FILTER_SHIFT_THEATSINK, 
+  [MEAS_15V]       = ADC_FILTER_SHIFT_15V, 
+  [MEAS_VOUT]      = ADC_FILTER_SHIFT_VOUT, 
+  [MEAS_IIN1]      = ADC_FILTER_SHIFT_IIN1, 
+  [MEAS_VIN1]      = ADC_FILTER_SHIFT_VIN1, 
+}; 
+
+/* The integrators are free-running and only ever written by the ADC 
+   ISR. Readers keep their own copy of the last values they saw and 
+   take the difference, so nothing outside the ISR has to zero them. 
+   Only Vin and Iin are integrated. A 32 bit integrator of 12 bit 
+   samples and the 16 bit sample count both stay valid across 
+   wrap-around as long as they are read at least every 65535 samples 
+   (56s), pv_track reads them at PV_HZ. */ 
 volatile uint32_t acc_value[ADC_NUM_CHANNELS]; 
-volatile uint16_t acc_num[ADC_NUM_CHANNELS]; 
+volatile uint16_t acc_num; 
+
+static uint32_t acc_last_value[ADC_NUM_CHANNELS]; 
+static uint16_t acc_last_num[ADC_NUM_CHANNELS]; 
+
+/* Incremented by the ADC ISR after every update. A reader that sees the 
+   same count before and after copying a 32 bit value was not 
+   interrupted by the ISR part way through, so the copy did not tear. */ 
+static volatile uint16_t adc_seq; 
 
 
 void init_adc(void) {
@@ -98,79 +154,76 @@ void init_adc(void) {
 	/* Enable interrupt for ADC12MCTL5 */
 	ADC12IE = (1 << 5);
 	
-	/* Zero out the sample array */ 
-        /* Clear sample arrays */
-        memset((uint16_t*)samples, 0, sizeof(samples[0])
-	       * ADC_NUM_CHANNELS);
+	/* Zero out the filters */ 
+        memset((uint16_t*)filter_state, 0, sizeof(filter_state)); 
 
 	/* Zero out the accumulator readings */ 
         memset((uint32_t*)acc_value, 0, sizeof(acc_value[0])
 	       * ADC_NUM_CHANNELS);
 
-        memset((uint16_t*)acc_num, 0, sizeof(acc_num[0])
-	       * ADC_NUM_CHANNELS);
+        acc_num = 0; 
+
+        memset(acc_last_value, 0, sizeof(acc_last_value)); 
+        memset(acc_last_num, 0, sizeof(acc_last_num)); 
+        adc_seq = 0; 
 
 
 	/* Enable conversions */
 	ADC12CTL0 |= ENC | ADC12SC;
 }
 
-/* Digital filtering scheme */ 
-/* Note that this does not implement higher-order filters */ 
-#define DIGITAL_FILTER(sample, new_sample){\
-sample += (new_sample);		    \
-sample >>= 1;			    \
+/* One first order IIR stage. x and y are at most 15 bits, so the 
+   difference cannot overflow 16 bits. */ 
+#define IIR_STAGE(y, x, shift){\
+  y += (int16_t)((x) - (y)) >> (shift); \
+}
+
+/* Run the filter cascade for channel i. i must be a constant. */ 
+#define DIGITAL_FILTER(i, new_sample){\
+  IIR_STAGE(filter_state[0][i], (new_sample) << ADC_FILTER_FRAC_BITS, \
+	    filter_shift[i]); \
+  if(filter_order[i] > 1) \
+    IIR_STAGE(filter_state[1][i], filter_state[0][i], filter_shift[i]); \
 }
 
 static inline uint16_t 
 read_adc_value(u08 channel){
-	return samples[channel];
+	uint16_t y = filter_state[filter_order[channel] - 1][channel]; 
+
+	/* Round off the fractional bits */ 
+	return (y + (1 << (ADC_FILTER_FRAC_BITS - 1))) >> ADC_FILTER_FRAC_BITS; 
 }
 
+/* A 16 bit read is a single instruction, so this cannot tear and 
+   there is no need to mask the control loop interrupt */ 
 u16 sample_adc(u08 channel){
-	uint16_t sample; 
-	
-	/* Disable the ADC interrupt */ 
-	ADC12IE &= ~(1 << 9);
-	
-	/* Short pause to make sure its off */ 
-	{volatile int i; 
-		for(i=15; i>0; i--)
-			; 
-	}
-	
-	sample = read_adc_value(channel); 
-	
-	/* Turn the interrupt back on again */ 
-	ADC12IE |= (1<<9); 
-	
 	/* Return the most recent value of the ADC - Unscaled */
-	return(sample); 
+	return read_adc_value(channel); 
 }
 
 #define ACCUMULATE_VALUE(i, new_sample){\
   acc_value[i] += new_sample; \
-  acc_num[i] ++; \
 }
 
+/* Returns the sum and number of samples since the last call for this 
+   channel. Must only be called from one context per channel (at the 
+   moment, the pv_track timer ISR). */ 
 void adc_acc_read_and_zero(int i, uint32_t* value, uint16_t* num){
-  /* Disable the ADC interrupt */ 
-  ADC12IE &= ~(1 << 9);
-  
-  /* Short pause to make sure its off */ 
-  {volatile int i; 
-    for(i=15; i>0; i--)
-      ; 
-  }
-  
-  *value = acc_value[i]; 
-  *num = acc_num[i]; 
+  uint32_t acc; 
+  uint16_t n, seq; 
+
+  do{
+    seq = adc_seq; 
+    acc = acc_value[i]; 
+    n = acc_num; 
+  }while(seq != adc_seq); 
 
-  acc_value[i] = 0;
-  acc_num[i] = 0; 
+  /* Unsigned differences are correct across wrap-around */ 
+  *value = acc - acc_last_value[i]; 
+  *num = n - acc_last_num[i]; 
 
-  /* Turn the interrupt back on again */ 
-  ADC12IE |= (1<<9); 
+  acc_last_value[i] = acc; 
+  acc_last_num[i] = n; 
 }
 
 /* Returns the number of samples */ 
@@ -179,8 +232,12 @@ uint32_t adc_acc_read_zero_divide(int i){
   uint16_t num; 
 
   adc_acc_read_and_zero(i, &value, &num); 
+
+  /* Called faster than the ADC -- fall back to the filtered value */ 
+  if(num == 0)
+    return sample_adc(i); 
   
-  return value / num;  
+  return (value + (num >> 1)) / num;  
 }
 
 
@@ -236,6 +293,48 @@ pid_ctrl (int32_t ek,
   return value;
 }
 
+/* Duty feed-forward 
+   -- 
+   In steady state the boost runs at D = 1 - Vin / Vout, so a new target 
+   needs the duty to move by the change in that. Rather than add it to 
+   the input loop's output in the ADC ISR, the loop's integrator is 
+   stepped by the change whenever the target moves. It comes to the same 
+   thing, with the integrator holding the difference between the 
+   feed-forward and the duty the loop actually needs. Returns the 
+   feed-forward for target raw, in control loop output units, from the 
+   Vout reciprocal calibration_poll() keeps -- so with no divide, since 
+   set_target() runs in the Timer B ISR. */ 
+static int32_t 
+feedforward(int32_t raw){
+  int32_t vin, d; 
+
+  vin = calibration_scale(CAL_VIN, raw); 
+  if(calibration_recip.per_mv == 0 || calibration_recip.vout <= vin)
+    return 0; 
+
+  d = calibration_recip.period - 
+    ((vin * calibration_recip.per_mv) >> CAL_RECIP_SHIFT); 
+  return (d * config.feedforward_gain) << (14 - FEEDFORWARD_SHIFT); 
+}
+
+/* Only evaluated while the feed-forward is on. Both ends of the step 
+   are taken at the present Vout, so there's nothing to carry between 
+   targets, and it can be switched on or off while tracking. */ 
+static void 
+set_target(int32_t raw){
+  int32_t step = 0; 
+
+  if(config.feedforward)
+    step = feedforward(raw) - feedforward(target); 
+
+  ADC_INTERRUPT_DISABLE();
+  if(target != raw)
+    scope_trigger(SCOPE_TRIG_TARGET); 
+  target = raw; 
+  in_pid_data.integral += step; 
+  ADC_INTERRUPT_ENABLE(); 
+}
+
 void control_set_voltage(int32_t mvolts){
   int32_t min_vin; 
   
@@ -244,11 +343,9 @@ void control_set_voltage(int32_t mvolts){
     mvolts = config.min_vin;
 
   /* Convert to ADC reading */
-  scandal_get_unscaled_value(UNSWMPPTNG_IN_VOLTAGE, &mvolts);
+  mvolts = calibration_unscale(CAL_VIN, mvolts);
 
-  ADC_INTERRUPT_DISABLE();
-  target = mvolts;
-  ADC_INTERRUPT_ENABLE();	
+  set_target(mvolts); 
 }
 
 void control_set_raw(int16_t raw){
@@ -256,9 +353,7 @@ void control_set_raw(int16_t raw){
   if(raw < min_vin_adc)
     raw = min_vin_adc; 
 
-  ADC_INTERRUPT_DISABLE();
-  target = raw; 
-  ADC_INTERRUPT_ENABLE(); 
+  set_target(raw); 
 }
 
 int32_t control_get_target(void){
@@ -266,16 +361,21 @@ int32_t control_get_target(void){
 }
 
 void tracker_panic(int error){
+  scope_trigger(SCOPE_TRIG_PANIC); 
   fpga_enable(FPGA_OFF); 
   tracker_status &= ~STATUS_TRACKING; 
   mpptng_error(error); 
+
+  /* Find out why, if it was the CPLD */ 
+  if(error == UNSWMPPTNG_ERROR_FPGA_SHUTDOWN)
+    fpga_queue_readback(); 
 }
 
 void control_init(void){
   active_loop = INPUT_LOOP; 
   output = PWM_MIN; 
 
-  /* FIXME: Should scale using the calibrated constants here */ 
+  calibration_update(); 
   update_control_maxmin(); 
   init_adc(); 
 }
@@ -283,10 +383,118 @@ void control_init(void){
 void control_start(){
 	pid_init(&in_pid_data); 
 	pid_init(&out_pid_data); 
+	/* Soft start: the integrator winds up from nothing, and only 
+	   changes of target from here on are fed forward */ 
 	output = PWM_MIN;
 	active_loop = INPUT_LOOP; 
 	tracker_status |= STATUS_INPUT_LOOP;
-	fpga_setpwm(output); 
+	tracker_status &= ~STATUS_OUTPUT_LOOP; 
+	control_update_gains(); 
+	fpga_write_pwm(PWM_TO_FPGA(output)); 
+}
+
+static void
+schedule_gains(pid_const_t* gains, volatile pid_const_t* base, uint8_t factor){
+  gains->Kp = ((base->Kp * factor) >> GAIN_SCHEDULE_SHIFT) / phases; 
+  gains->Ki = ((base->Ki * factor) >> GAIN_SCHEDULE_SHIFT) / phases; 
+  gains->Kd = ((base->Kd * factor) >> GAIN_SCHEDULE_SHIFT) / phases; 
+}
+
+static uint16_t
+current_to_adc(int32_t ma){
+  ma = calibration_unscale(CAL_IIN, ma); 
+  if(ma < 0)
+    ma = 0; 
+  else if(ma > 4095)
+    ma = 4095; 
+  return ma; 
+}
+
+/* Take up config's loop gains and gain schedule, divided by the boards 
+   switching. Safe to call while tracking: the divides are done first, 
+   and the ADC interrupt is only held off while each band is copied in. */ 
+void control_update_gains(void){
+  pid_const_t in, out; 
+  uint16_t up, down; 
+  int32_t ma; 
+  uint8_t b; 
+
+  for(b=0; b<GAIN_SCHEDULE_BANDS; b++){
+    schedule_gains(&in, &config.in_pid_const, config.in_gain_schedule[b]); 
+    schedule_gains(&out, &config.out_pid_const, config.out_gain_schedule[b]); 
+
+    ADC_INTERRUPT_DISABLE(); 
+    in_pid_const[b] = in; 
+    out_pid_const[b] = out; 
+    ADC_INTERRUPT_ENABLE(); 
+  }
+
+  for(b=0; b<GAIN_SCHEDULE_BANDS - 1; b++){
+    ma = (int32_t)config.gain_band_current * (b + 1); 
+    up = current_to_adc(ma); 
+    down = current_to_adc(ma - config.gain_band_current / GAIN_SCHEDULE_HYSTERESIS); 
+
+    ADC_INTERRUPT_DISABLE(); 
+    gain_band_up[b] = up; 
+    gain_band_down[b] = down; 
+    ADC_INTERRUPT_ENABLE(); 
+  }
+}
+
+/* Store input loop gains found at the present operating point in the 
+   config, undoing the division by the boards switching and the gain 
+   schedule factor of the band in use */ 
+void control_store_in_gains(pid_const_t* gains){
+  uint8_t factor = config.in_gain_schedule[gain_band]; 
+
+  config.in_pid_const.Kp = (gains->Kp * phases << GAIN_SCHEDULE_SHIFT) / factor; 
+  config.in_pid_const.Ki = (gains->Ki * phases << GAIN_SCHEDULE_SHIFT) / factor; 
+  config.in_pid_const.Kd = (gains->Kd * phases << GAIN_SCHEDULE_SHIFT) / factor; 
+  control_update_gains(); 
+}
+
+/* Hand the input loop back at output uk, from the auto-tuner's relay. 
+   Called with the ADC interrupt disabled. */ 
+void control_resume_input_loop(int32_t uk){
+  in_pid_data.integral = uk; 
+  in_pid_data.uk_1 = uk; 
+  in_pid_data.ek_1 = 0; 
+}
+
+/* Phase shedding 
+   -- 
+   Switch as many of the config.num_phases power boards as the input 
+   current needs, at config.phase_current each: add one as soon as 
+   those switching are all at that current, and shed one once the 
+   rest could take the current with a quarter of a board to spare. 
+   One board at a time, from the main loop every PHASE_UPDATE_PERIOD. */ 
+void control_update_phases(void){
+  int32_t iin, step; 
+  uint8_t want = phases; 
+  uint8_t fitted = config.num_phases; 
+
+  /* The CPLD image may drive fewer boards than were configured */ 
+  if(fitted > FPGA_MAX_PHASES)
+    fitted = FPGA_MAX_PHASES; 
+
+  if(fitted <= 1 && phases == 1)
+    return; 
+
+  iin = calibration_scale(CAL_IIN, sample_adc(MEAS_IIN1)); 
+  step = config.phase_current; 
+
+  if(want > fitted)
+    want = fitted; 
+  else if(want < fitted && iin > want * step)
+    want++; 
+  else if(want > 1 && iin < (want - 1) * step - step / PHASE_SHED_HYSTERESIS)
+    want--; 
+
+  if(want != phases){
+    phases = want; 
+    fpga_set_phases(phases); 
+    control_update_gains(); 
+  }
 }
 
 /* -------------------------------
@@ -301,9 +509,6 @@ void control_start(){
 #define ADC12MEM_THEATSINK		ADC12MEM1
 #define ADC12MEM_TAMBIENT		ADC12MEM0
 
-/* FIXME -- should be set to the maximum output voltage, converted to the equivalent ADC reading
-	     -- should be updated whenever the config is updated */
-
 volatile void set_max_vout_adc(uint16_t new_vout_adc){
   ADC_INTERRUPT_DISABLE();
   max_vout_adc = new_vout_adc; 
@@ -316,29 +521,67 @@ volatile void set_min_vin_adc(uint16_t new_vin_adc){
   ADC_INTERRUPT_ENABLE(); 
 }
 
+/* Called whenever the config limits or the calibration change */ 
 volatile void update_control_maxmin(void){
-  int32_t value; 
+  uint16_t max_vout, min_vin; 
   
-  value = config.max_vout; 
-  scandal_get_unscaled_value(UNSWMPPTNG_OUT_VOLTAGE, &value); 
-  set_max_vout_adc(value); 
+  set_max_vout_adc(calibration_unscale(CAL_VOUT, config.max_vout)); 
+  set_min_vin_adc(calibration_unscale(CAL_VIN, config.min_vin)); 
+
+  max_vout = calibration_unscale(CAL_VOUT, ABS_MAX_VOUT); 
+  min_vin = calibration_unscale(CAL_VIN, ABS_MIN_VIN); 
 
-  value = config.min_vin; 
-  scandal_get_unscaled_value(UNSWMPPTNG_IN_VOLTAGE, &value); 
-  set_min_vin_adc(value); 
+  ADC_INTERRUPT_DISABLE();
+  abs_max_vout_adc = max_vout; 
+  abs_min_vin_adc = min_vin; 
+  ADC_INTERRUPT_ENABLE(); 
 }
 
-interrupt (ADC_VECTOR) ADC12ISR(void) {
-  uint32_t uk = OUT_MIN, in_uk = OUT_MIN, out_uk=OUT_MIN;  
+/* Loop changeover 
+   -- 
+   The input and output loops both run every sample and the lower of 
+   their outputs is applied. The integrator of the loop not in control 
+   tracks the output actually applied, plus CHANGEOVER_HYSTERESIS 
+   (external reset feedback), so it can't wind up against OUT_MAX (the 
+   output loop, below the battery limit) or hold the duty up (the input 
+   loop, while the output is limited). Its proportional and derivative 
+   terms alone then decide when it takes over: once they have brought 
+   it the hysteresis below the loop in control, which it does from 
+   the same output, without a bump. The hysteresis keeps noise about 
+   either setpoint from flicking the loops back and forth. */ 
+#define CHANGEOVER_HYSTERESIS PWM_TO_OUTPUT(OUTPUT_LOOP_CHANGEOVER_HYSTERESIS)
+
+static inline int32_t 
+pid_follow(volatile pid_data_t* pid_data, int32_t uk, int32_t active_uk){
+  int32_t value; 
+
+  /* pid_ctrl() leaves the proportional and derivative terms in 
+     uk - integral, clamped or not */ 
+  value = uk - pid_data->integral; 
+  pid_data->integral = active_uk + CHANGEOVER_HYSTERESIS; 
+  value += pid_data->integral; 
+
+  if(value > OUT_MAX)
+    value = OUT_MAX; 
+  else if(value < OUT_MIN)
+    value = OUT_MIN; 
+
+  pid_data->uk_1 = value; 
+  return value; 
+}
+
+static inline void control_isr(void){
+  int32_t uk = OUT_MIN, in_uk = OUT_MIN, out_uk=OUT_MIN;  
   int16_t vout = ADC12MEM_VOUT; 
   int16_t vin  = ADC12MEM_VIN1;
+  uint16_t iin; 
 
-	if(vout > ADC_ABS_MAX_VOUT){
+	if(vout > (int16_t)abs_max_vout_adc){
 		tracker_panic(UNSWMPPTNG_ERROR_OUTPUT_OVER_VOLTAGE); 
-	}else if(vin < ADC_ABS_MIN_VIN){
+	}else if(vin < (int16_t)abs_min_vin_adc){
 		tracker_panic(UNSWMPPTNG_ERROR_INPUT_UNDER_VOLTAGE);
 	}else if((tracker_status & STATUS_TRACKING) == 0){
-	        fpga_setpwm(PWM_MIN); 
+	        fpga_setpwm(PWM_TO_FPGA(PWM_MIN)); 
 	}else{
 		/* If we have a fault signal from the FPGA, panic */
 		if(fpga_nFS() == 0){
@@ -346,41 +589,72 @@ interrupt (ADC_VECTOR) ADC12ISR(void) {
 			return; 
 		}
 
+		/* Move at most one gain schedule band a sample */ 
+		iin = read_adc_value(MEAS_IIN1); 
+		if(gain_band < GAIN_SCHEDULE_BANDS - 1 && iin >= gain_band_up[gain_band])
+		  gain_band++; 
+		else if(gain_band > 0 && iin < gain_band_down[gain_band - 1])
+		  gain_band--; 
+
 		/* Run the output control loop */ 
-		out_uk = pid_ctrl(vout - (int16_t)max_vout_adc, &out_pid_data, &config.out_pid_const);
+		out_uk = pid_ctrl(vout - (int16_t)max_vout_adc, &out_pid_data, &out_pid_const[gain_band]);
 		
-		in_uk = pid_ctrl(vin-target, &in_pid_data, &config.in_pid_const);
+		if(autotune.state == AUTOTUNE_RELAY)
+		  in_uk = autotune_relay(vin-target); 
+		else
+		  in_uk = pid_ctrl(vin-target, &in_pid_data, &in_pid_const[gain_band]);
+
+		if(active_loop == INPUT_LOOP){
+		  out_uk = pid_follow(&out_pid_data, out_uk, in_uk); 
+		  if(out_uk < in_uk){
+		    active_loop = OUTPUT_LOOP; 
+		    scope_trigger(SCOPE_TRIG_CHANGEOVER); 
+		    tracker_status |= STATUS_OUTPUT_LOOP; 
+		    tracker_status &= ~STATUS_INPUT_LOOP; 
+		  }
+		}else{
+		  in_uk = pid_follow(&in_pid_data, in_uk, out_uk); 
+		  if(in_uk < out_uk){
+		    active_loop = INPUT_LOOP; 
+		    scope_trigger(SCOPE_TRIG_CHANGEOVER); 
+		    tracker_status |= STATUS_INPUT_LOOP; 
+		    tracker_status &= ~STATUS_OUTPUT_LOOP; 
+		  }
+		}
 
-		if(out_uk < in_uk)
+		if(active_loop == OUTPUT_LOOP)
 		  uk = out_uk; 
 		else
 		  uk = in_uk; 
 		
-		fpga_setpwm(OUTPUT_TO_PWM(uk));
+		fpga_setpwm(OUTPUT_TO_FPGA(uk));
 		output = OUTPUT_TO_PWM(uk); 
 		control_error = out_uk; /*vout - (int16_t)max_vout_adc;*/ 
-
-		if(out_uk > in_uk){
-		  tracker_status |= STATUS_INPUT_LOOP; 
-		  tracker_status &= ~STATUS_OUTPUT_LOOP; 
-		}else{
-		  tracker_status |= STATUS_OUTPUT_LOOP; 
-		  tracker_status &= ~STATUS_INPUT_LOOP; 
-		}
 	}
 
+	scope_record(vin | ((tracker_status & STATUS_OUTPUT_LOOP) ? SCOPE_LOOP_FLAG : 0), 
+		     vout, ADC12MEM_IIN1, output); 
+
 	/* We do any extra gumph for the rest of the system here */ 
-	DIGITAL_FILTER(samples[0], ADC12MEM0);
-	DIGITAL_FILTER(samples[1], ADC12MEM1);
-	DIGITAL_FILTER(samples[2], ADC12MEM2);
-	DIGITAL_FILTER(samples[3], ADC12MEM3);
-	DIGITAL_FILTER(samples[4], ADC12MEM4);
-	DIGITAL_FILTER(samples[5], ADC12MEM0);
-
-	ACCUMULATE_VALUE(0, ADC12MEM0)
-	ACCUMULATE_VALUE(1, ADC12MEM1)
-	ACCUMULATE_VALUE(2, ADC12MEM2)
-	ACCUMULATE_VALUE(3, ADC12MEM3)
-	ACCUMULATE_VALUE(4, ADC12MEM4)
-	ACCUMULATE_VALUE(5, ADC12MEM5)
+	DIGITAL_FILTER(MEAS_TAMBIENT, ADC12MEM_TAMBIENT);
+	DIGITAL_FILTER(MEAS_THEATSINK, ADC12MEM_THEATSINK);
+	DIGITAL_FILTER(MEAS_15V, ADC12MEM_15V);
+	DIGITAL_FILTER(MEAS_VOUT, vout);
+	DIGITAL_FILTER(MEAS_IIN1, ADC12MEM_IIN1);
+	DIGITAL_FILTER(MEAS_VIN1, vin);
+
+	ACCUMULATE_VALUE(MEAS_IIN1, ADC12MEM_IIN1)
+	ACCUMULATE_VALUE(MEAS_VIN1, vin)
+	acc_num++; 
+
+	adc_seq++; 
+}
+
+interrupt (ADC_VECTOR) ADC12ISR(void) {
+  ISR_STATS_ENTER(); 
+
+  control_isr(); 
+
+  ISR_STATS_EXIT(ISR_STATS_ADC, 
+		 isr_stats_interval_jitter(ISR_STATS_ADC, isr_stats_entry)); 
 }
@@ -17,23 +17,271 @@
  * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <io.h>
+#include <signal.h>
+
 #include <scandal/types.h>
 #include <scandal/leds.h>
+#include <scandal/engine.h>
+#include <scandal/message.h>
 
 #include <project/hardware.h>
 #include <project/other_spi.h>
 #include <project/spi_devices.h>
 #include <project/fpga.h>
 #include <project/mpptng.h>
+#include <project/isr_stats.h>
+
+volatile fpga_spi_t fpga_spi; 
+volatile fpga_readback_t fpga_readback; 
+
+static u08 sent_count;      /* fpga_readback.count when last looked at */ 
+static u08 sent_cause;      /* Causes already reported */ 
+
+static const u16 fpga_defaults[FPGA_NUM_SIGNALS] = {
+	DEFAULT_RESTART, 
+	DEFAULT_AUX_LENGTH, 
+	DEFAULT_AUX_OVERLAP, 
+	DEFAULT_PWM, 
+	DEFAULT_PWM_FRAC, 
+	DEFAULT_DEADTIME, 
+	DEFAULT_PHASE, 
+}; 
+
+/* Registers every board that switches has the same value in, 
+   as board 1 has them */ 
+static const u08 fpga_common[] = {
+	SIGNAL_RESTART, 
+	SIGNAL_AUX_LENGTH, 
+	SIGNAL_AUX_OVERLAP, 
+	SIGNAL_DEADTIME, 
+	SIGNAL_PWM, 
+	SIGNAL_PWM_FRAC, 
+}; 
 
 void fpga_init(void){
+	u08 board, signal; 
+
 	init_spi0();
 
-	fpga_transfer(1, SIGNAL_RESTART, DEFAULT_RESTART);
-	fpga_transfer(1, SIGNAL_AUX_LENGTH, DEFAULT_AUX_LENGTH);
-	fpga_transfer(1, SIGNAL_AUX_OVERLAP, DEFAULT_AUX_OVERLAP);
-	fpga_transfer(1, SIGNAL_PWM, DEFAULT_PWM);
-	fpga_transfer(1, SIGNAL_DEADTIME, DEFAULT_DEADTIME);
+	/* All of the registers of each board in one frame. Only board 1 
+	   switches to start with, the others have their aux pulse off 
+	   too. Writes to boards the CPLD doesn't have go nowhere. */ 
+	for(board = 0; board < FPGA_NUM_BOARDS; board++){
+		for(signal = 0; signal < FPGA_NUM_SIGNALS; signal++)
+			fpga_spi.value[board][signal] = fpga_defaults[signal]; 
+		if(board != 0)
+			fpga_spi.value[board][SIGNAL_AUX_LENGTH] = 0; 
+		fpga_transfer(FPGA_BOARD + board, 0, 
+			      (const u16*)fpga_spi.value[board], FPGA_NUM_SIGNALS);
+		fpga_spi.dirty[board] = 0; 
+	}
+	fpga_spi.phases = 1; 
+	fpga_spi.state = FPGA_SPI_IDLE; 
 
 	fpga_reset(); 
+
+	/* Everything from here on goes through usart0rx() */ 
+	IFG1 &= ~URXIFG0; 
+	IE1 |= URXIE0; 
+}
+
+/* Spread the boards that are switching evenly over board 1's cycle. 
+   Called with interrupts off, whenever the number of them or the 
+   period changes. */ 
+static void 
+fpga_mark_phases(void){
+	u16 cycle; 
+	u08 b; 
+
+	cycle = FPGA_CYCLE_CLKS(fpga_spi.value[0][SIGNAL_RESTART]); 
+	for(b = 1; b < fpga_spi.phases; b++)
+		fpga_mark(FPGA_BOARD + b, SIGNAL_PHASE, 
+			  cycle * b / fpga_spi.phases - FPGA_PHASE_LOCK); 
+}
+
+/* For use outside the ADC ISR. Goes to every board that is 
+   switching. GIE is left as it was found, so it can be called with 
+   interrupts already off. */ 
+void fpga_write(u08 signal, u16 value){
+	u08 board; 
+	u16 sr; 
+
+	sr = READ_SR & GIE; 
+	dint(); 
+	for(board = FPGA_BOARD; board < FPGA_BOARD + fpga_spi.phases; board++)
+		fpga_mark(board, signal, value); 
+	if(signal == SIGNAL_RESTART)
+		fpga_mark_phases(); 
+	fpga_kick(); 
+	_BIS_SR(sr); 
+}
+
+/* Write count consecutive registers, starting at signal, in one 
+   frame per board, e.g. the PWM together with the aux timing. The 
+   CPLD never runs with some of them old and some new. */ 
+void fpga_write_burst(u08 signal, const u16* values, u08 count){
+	u08 b, i; 
+	u16 sr; 
+
+	sr = READ_SR & GIE; 
+	dint(); 
+	for(b = 0; b < fpga_spi.phases; b++){
+		for(i = 0; i < count; i++){
+			fpga_spi.value[b][signal + i] = values[i]; 
+			fpga_spi.dirty[b] |= (1 << (signal + i)) & FPGA_SIGNALS_SENT; 
+		}
+	}
+	if(signal == SIGNAL_RESTART)
+		fpga_mark_phases(); 
+	if(fpga_spi.state == FPGA_SPI_IDLE)
+		fpga_spi_start(); 
+	_BIS_SR(sr); 
+}
+
+/* Switch the first phases boards, spread evenly over board 1's 
+   cycle, and shed the rest. A board joining takes board 1's timing 
+   and PWM, so it starts where the others are. Boards the CPLD 
+   doesn't have are written anyway, and ignore it. */ 
+void fpga_set_phases(u08 phases){
+	u08 b, i; 
+	u16 sr; 
+
+	if(phases < 1)
+		phases = 1; 
+	if(phases > FPGA_MAX_PHASES)
+		phases = FPGA_MAX_PHASES; 
+
+	sr = READ_SR & GIE; 
+	dint(); 
+	for(b = 1; b < FPGA_NUM_BOARDS; b++){
+		if(b < phases){
+			for(i = 0; i < sizeof(fpga_common); i++)
+				fpga_mark(FPGA_BOARD + b, fpga_common[i], 
+					  fpga_spi.value[0][fpga_common[i]]); 
+		}else{
+			fpga_mark(FPGA_BOARD + b, SIGNAL_AUX_LENGTH, 0); 
+			fpga_mark(FPGA_BOARD + b, SIGNAL_PWM, 0); 
+			fpga_mark(FPGA_BOARD + b, SIGNAL_PWM_FRAC, 0); 
+		}
+	}
+	fpga_spi.phases = phases; 
+	fpga_mark_phases(); 
+	fpga_kick(); 
+	_BIS_SR(sr); 
+}
+
+void fpga_write_pwm(u16 value){
+	dint(); 
+	fpga_setpwm(value); 
+	eint(); 
+}
+
+void fpga_request_readback(void){
+	dint(); 
+	fpga_queue_readback(); 
+	eint(); 
+}
+
+static inline void 
+fpga_readback_done(void){
+	volatile u08* rx = fpga_spi.rx; 
+
+	fpga_readback.cause = rx[0]; 
+	fpga_readback.live = rx[1]; 
+	fpga_readback.main_length = ((u16)rx[2] << 8 | rx[3]) & 0x07FF; 
+	fpga_readback.period = ((u16)rx[4] << 8 | rx[5]) & 0x07FF; 
+	fpga_readback.cycles = (u16)rx[6] << 8 | rx[7]; 
+	fpga_readback.count++; 
+}
+
+static inline void 
+fpga_send_status(void){
+	scandal_send_channel(TELEM_LOW, UNSWMPPTNG_FPGA_STATUS, 
+			     (u32)fpga_readback.cause << 24 
+			     | (u32)fpga_readback.live << 16 
+			     | fpga_readback.cycles); 
+}
+
+/* Every telemetry period. Sends what the last readback found and 
+   asks for the next one. The legacy image has nothing to send. */ 
+void fpga_send_telemetry(void){
+#ifndef FPGA_LEGACY_SPI
+	fpga_send_status(); 
+	scandal_send_channel(TELEM_LOW, UNSWMPPTNG_FPGA_APPLIED, 
+			     (u32)fpga_readback.main_length << 16 
+			     | fpga_readback.period); 
+	fpga_request_readback(); 
+#endif
+}
+
+/* Called from the main loop: report a new shutdown cause as soon as 
+   a readback turns it up, whatever the telemetry mode */ 
+void fpga_send_data(void){
+	if(fpga_readback.count == sent_count)
+		return; 
+	sent_count = fpga_readback.count; 
+
+	if(fpga_readback.cause != sent_cause){
+		sent_cause = fpga_readback.cause; 
+		if(sent_cause != 0)
+			fpga_send_status(); 
+	}
+}
+
+/* One interrupt per received byte, or fewer if the ADC ISR held 
+   us off for longer than a byte. Only act once the shift register 
+   is empty, except during a readback, which only ever has one byte 
+   in flight. */ 
+interrupt (USART0RX_VECTOR) usart0rx(void){
+	ISR_STATS_ENTER(); 
+
+	u08 in = RXBUF0; 
+
+#ifdef FPGA_LEGACY_SPI
+	/* Raise chip select once the word has shifted out, clock the 
+	   trailing byte, then start the next register that is waiting */ 
+	(void)in; 
+	if(U0TCTL & TXEPT){
+		if(fpga_spi.state == FPGA_SPI_FRAME){
+			DISABLE_FPGA_SPI(); 
+			fpga_spi.state = FPGA_SPI_TRAIL; 
+			spi0_send(0x00); 
+		}else if(fpga_dirty()){
+			fpga_spi_start(); 
+		}else{
+			fpga_spi.state = FPGA_SPI_IDLE; 
+		}
+	}
+#else
+	if(fpga_spi.state == FPGA_SPI_READ){
+		/* One byte in flight, so this is the one we just sent */ 
+		if(fpga_spi.next <= FPGA_READBACK_BYTES)
+			fpga_spi.rx[fpga_spi.next - 1] = in; 
+
+		if(fpga_spi.next < fpga_spi.count){
+			spi0_send(fpga_spi.frame[fpga_spi.next++]); 
+		}else{
+			fpga_readback_done(); 
+			DISABLE_FPGA_SPI(); 
+			if(fpga_dirty() || fpga_spi.read)
+				fpga_spi_start(); 
+			else
+				fpga_spi.state = FPGA_SPI_IDLE; 
+		}
+	}else if(U0TCTL & TXEPT){
+		if(fpga_spi.next < fpga_spi.count){
+			spi0_send(fpga_spi.frame[fpga_spi.next++]); 
+			spi0_send(fpga_spi.frame[fpga_spi.next++]); 
+		}else{
+			DISABLE_FPGA_SPI(); 
+			if(fpga_dirty() || fpga_spi.read)
+				fpga_spi_start(); 
+			else
+				fpga_spi.state = FPGA_SPI_IDLE; 
+		}
+	}
+#endif
+
+	ISR_STATS_EXIT(ISR_STATS_SPI0, 0); 
 }
@@ -0,0 +1,168 @@
+/* Copyright (C) agent, 2026 */ 
+
+/* 
+ * This file is part of the UNSWMPPTNG firmware.
+ * 
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ 
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ 
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* ISR timing instrumentation -- reporting. See isr_stats.h */ 
+
+#include <io.h>
+#include <signal.h>
+#include <string.h>
+
+#include <scandal/engine.h>
+#include <scandal/message.h>
+#include <scandal/error.h>
+#include <scandal/can.h>
+#include <scandal/devices.h>
+
+#include <project/mpptng.h>
+#include <project/isr_stats.h>
+
+#if ISR_STATS
+
+volatile isr_stats_t isr_stats[ISR_STATS_NUM]; 
+
+/* Taken when a report is requested, so the ISRs can carry on */ 
+static isr_stats_t snapshot[ISR_STATS_NUM]; 
+static int         send_index = -1; 
+
+static void 
+isr_stats_clear(volatile isr_stats_t* s){
+  uint16_t last_entry = s->last_entry; 
+  uint16_t last_interval = s->last_interval; 
+  uint8_t primed = s->primed; 
+
+  memset((isr_stats_t*)s, 0, sizeof(*s)); 
+  s->min = 0xFFFF; 
+
+  /* Keep the interval history so the next entry still has a reference */ 
+  s->last_entry = last_entry; 
+  s->last_interval = last_interval; 
+  s->primed = primed; 
+}
+
+void isr_stats_init(void){
+  int i; 
+
+  for(i=0; i<ISR_STATS_NUM; i++)
+    isr_stats_clear(&isr_stats[i]); 
+}
+
+/* Snapshot and clear the statistics, then start sending them */ 
+int isr_stats_send(void){
+  int i; 
+
+  dint(); 
+  for(i=0; i<ISR_STATS_NUM; i++){
+    memcpy(&snapshot[i], (isr_stats_t*)&isr_stats[i], sizeof(snapshot[i])); 
+    isr_stats_clear(&isr_stats[i]); 
+  }
+  eint(); 
+
+  send_index = 0; 
+  return 1; 
+}
+
+static inline void 
+put_cycles(u08* data, uint32_t ticks){
+  uint32_t cycles = ticks << ISR_STATS_TICK_SHIFT; 
+
+  if(cycles > 0xFFFF)
+    cycles = 0xFFFF; 
+  data[0] = (cycles >> 8) & 0xFF; 
+  data[1] = cycles & 0xFF; 
+}
+
+static inline void 
+put_count(u08* data, uint16_t count){
+  data[0] = (count >> 8) & 0xFF; 
+  data[1] = count & 0xFF; 
+}
+
+void isr_stats_send_data(void){
+  int burst; 
+
+  for(burst = 0; burst < ISR_STATS_SEND_BURST; burst++){
+    isr_stats_t* s; 
+    can_msg msg; 
+    int id, kind; 
+
+    if(send_index < 0 || send_index >= ISR_STATS_NUM * ISR_STATS_FRAMES){
+      send_index = -1; 
+      return; 
+    }
+
+    id = send_index / ISR_STATS_FRAMES; 
+    kind = send_index % ISR_STATS_FRAMES; 
+    s = &snapshot[id]; 
+
+    msg.id = scandal_mk_channel_id(TELEM_LOW, scandal_get_addr(), 
+				   UNSWMPPTNG_ISR_STATS); 
+    msg.length = 8; 
+    memset(msg.data, 0, sizeof(msg.data)); 
+    msg.data[0] = id; 
+    msg.data[1] = kind; 
+
+    switch(kind){
+    case 0:
+      put_cycles(&msg.data[2], s->count ? s->min : 0); 
+      put_cycles(&msg.data[4], s->max); 
+      put_cycles(&msg.data[6], s->count ? s->total / s->count : 0); 
+      break; 
+    case 1:
+      {
+	uint32_t count = s->count > 0xFFFFFFL ? 0xFFFFFFL : s->count; 
+
+	msg.data[2] = (count >> 16) & 0xFF; 
+	msg.data[3] = (count >> 8) & 0xFF; 
+	msg.data[4] = count & 0xFF; 
+	put_cycles(&msg.data[5], s->max_jitter); 
+      }
+      break; 
+    case 2:
+      put_count(&msg.data[2], s->hist[0]); 
+      put_count(&msg.data[4], s->hist[1]); 
+      put_count(&msg.data[6], s->hist[2]); 
+      break; 
+    case 3:
+      put_count(&msg.data[2], s->hist[3]); 
+      put_count(&msg.data[4], s->hist[4]); 
+      put_count(&msg.data[6], s->hist[5]); 
+      break; 
+    }
+
+    if(can_send_msg(&msg, TELEM_LOW) != NO_ERR)
+      return; 
+
+    send_index++; 
+  }
+}
+
+#else
+
+void isr_stats_init(void){
+}
+
+/* Not built with ISR_STATS -- nothing to send */ 
+int isr_stats_send(void){
+  return 0; 
+}
+
+void isr_stats_send_data(void){
+}
+
+#endif
@@ -41,6 +41,10 @@
 #include <project/mpptng.h>
 #include <project/control.h>
 #include <project/pv_track.h>
+#include <project/scope.h>
+#include <project/isr_stats.h>
+#include <project/autotune.h>
+#include <project/calibration.h>
 #include <project/mpptng_error.h>
 #include <project/config.h>
 #include <project/hardware.h>
@@ -75,6 +79,102 @@ kick_watchdog(void){
 #endif
 
 
+/* Ambient temperature in the units expected by the channel scaling */ 
+static int32_t 
+ambient_temp_prescaled(void){
+    int32_t degC = sample_adc(MEAS_TAMBIENT); 
+    return (((degC - 1615)*704*1000)/4095);
+}
+
+static void 
+send_channel_telemetry(void){
+    pv_track_send_telemetry(); 
+    /* We send the Input current and voltage from 
+        within the pvtrack module */ 
+
+    /*  scandal_send_scaled_channel(TELEM_LOW, UNSWMPPTNG_IN_VOLTAGE, 
+                    sample_adc(MEAS_VIN1));
+        scandal_send_scaled_channel(TELEM_LOW, UNSWMPPTNG_IN_CURRENT, 
+                    sample_adc(MEAS_IIN1));*/ 
+
+    scandal_send_scaled_channel(TELEM_LOW, UNSWMPPTNG_OUT_VOLTAGE, 
+                sample_adc(MEAS_VOUT));
+    scandal_send_scaled_channel(TELEM_LOW, UNSWMPPTNG_HEATSINK_TEMP, 
+                sample_adc(MEAS_THEATSINK));
+    scandal_send_scaled_channel(TELEM_LOW, UNSWMPPTNG_15V, 
+                sample_adc(MEAS_15V));
+    scandal_send_channel(TELEM_LOW, UNSWMPPTNG_STATUS, 
+                tracker_status); 
+
+    /* Pre-scale for the temperature */ 
+    scandal_send_scaled_channel(TELEM_LOW, UNSWMPPTNG_AMBIENT_TEMP, 
+                                ambient_temp_prescaled());
+
+    /* What the CPLD last said it was doing */ 
+    fpga_send_telemetry(); 
+
+#if DEBUG >= 1
+    scandal_send_channel(TELEM_LOW, 134, output);	
+    scandal_send_channel(TELEM_LOW, 136, fpga_nFS()); 
+#endif
+}
+
+/* Scale a raw reading on a channel, divide it down to the packed 
+   resolution and saturate it to 16 bits */ 
+static uint16_t 
+pack_unsigned(u16 channel, int32_t raw, int32_t divisor){
+    scandal_get_scaled_value(channel, &raw); 
+    raw /= divisor; 
+    if(raw < 0)
+        return 0; 
+    if(raw > 0xFFFF)
+        return 0xFFFF; 
+    return raw; 
+}
+
+static int16_t 
+pack_signed(u16 channel, int32_t raw, int32_t divisor){
+    scandal_get_scaled_value(channel, &raw); 
+    raw /= divisor; 
+    if(raw < -0x8000)
+        return -0x8000; 
+    if(raw > 0x7FFF)
+        return 0x7FFF; 
+    return raw; 
+}
+
+static inline void 
+put16(u08* data, uint16_t value){
+    data[0] = (value >> 8) & 0xFF; 
+    data[1] = value & 0xFF; 
+}
+
+/* See mpptng.h for the frame layout */ 
+static void 
+send_packed_telemetry(void){
+    can_msg msg; 
+
+    msg.length = 8; 
+    msg.id = mpptng_mk_raw_id(TELEM_LOW, UNSWMPPTNG_PACKED_TELEM_0); 
+    put16(&msg.data[0], pack_unsigned(UNSWMPPTNG_IN_VOLTAGE, vin_raw, 10)); 
+    put16(&msg.data[2], pack_unsigned(UNSWMPPTNG_IN_CURRENT, iin_raw, 1)); 
+    put16(&msg.data[4], pack_unsigned(UNSWMPPTNG_OUT_VOLTAGE, 
+                                      sample_adc(MEAS_VOUT), 10)); 
+    put16(&msg.data[6], output); 
+    can_send_msg(&msg, TELEM_LOW); 
+
+    msg.id = mpptng_mk_raw_id(TELEM_LOW, UNSWMPPTNG_PACKED_TELEM_1); 
+    put16(&msg.data[0], pack_signed(UNSWMPPTNG_HEATSINK_TEMP, 
+                                    sample_adc(MEAS_THEATSINK), 10)); 
+    put16(&msg.data[2], pack_signed(UNSWMPPTNG_AMBIENT_TEMP, 
+                                    ambient_temp_prescaled(), 10)); 
+    put16(&msg.data[4], pack_unsigned(UNSWMPPTNG_15V, 
+                                      sample_adc(MEAS_15V), 1)); 
+    msg.data[6] = tracker_status; 
+    msg.data[7] = pv_algorithm; 
+    can_send_msg(&msg, TELEM_LOW); 
+}
+
 void init_ports(void){
   P1OUT = 0x00;
   P1SEL = 0x00;
@@ -143,14 +243,19 @@ void disable_can_interrupt(){
 /* Interrupt handler associated with internal RTC */
 /* Timer A overflow interrupt */
 interrupt (PORT1_VECTOR) port1int(void) {
+  ISR_STATS_ENTER(); 
+
   can_interrupt();
   P1IFG = 0x00;
+
+  ISR_STATS_EXIT(ISR_STATS_PORT1, 0); 
 }
 
 
 /* Main function */
 int main(void) {
   sc_time_t     my_timer;  
+  sc_time_t     phase_timer; 
   int32_t value; 
 
   dint();
@@ -194,9 +299,12 @@ int main(void) {
   /* Initialise the PV tracking mechanism */ 
   pv_track_init(); 
 
+  isr_stats_init(); 
+
   eint();
 
   my_timer = sc_get_timer(); 
+  phase_timer = my_timer; 
 
   while (1) {
     sc_time_t timeval; 
@@ -208,6 +316,28 @@ int main(void) {
     /* pv_track sends data when it feels like it */ 
     pv_track_send_data(); 
 
+    /* As do the scope and ISR statistics, once asked */ 
+    scope_send_data(); 
+    isr_stats_send_data(); 
+
+    /* A new CPLD shutdown cause goes out straight away */ 
+    fpga_send_data(); 
+
+    /* Run the auto-tuner, if it's been started */ 
+    autotune_poll(); 
+
+    /* Write the config once a burst of changes has settled */ 
+    config_flush(); 
+
+    /* Take up any new m and b for the channels the tracker converts */ 
+    calibration_poll(); 
+
+    /* Add or shed power boards as the input current changes */ 
+    if(timeval >= phase_timer + PHASE_UPDATE_PERIOD){
+        phase_timer = timeval; 
+        control_update_phases(); 
+    }
+
     /* Periodically send out the values recorded by the ADC */ 
     if(timeval >= my_timer + TELEMETRY_UPDATE_PERIOD){
         my_timer = timeval;
@@ -218,36 +348,10 @@ int main(void) {
         
         mpptng_do_errors(); 
 
-        pv_track_send_telemetry(); 
-        /* We send the Input current and voltage from 
-            within the pvtrack module */ 
-
-        /*  scandal_send_scaled_channel(TELEM_LOW, UNSWMPPTNG_IN_VOLTAGE, 
-                        sample_adc(MEAS_VIN1));
-            scandal_send_scaled_channel(TELEM_LOW, UNSWMPPTNG_IN_CURRENT, 
-                        sample_adc(MEAS_IIN1));*/ 
-
-        scandal_send_scaled_channel(TELEM_LOW, UNSWMPPTNG_OUT_VOLTAGE, 
-                    sample_adc(MEAS_VOUT));
-        scandal_send_scaled_channel(TELEM_LOW, UNSWMPPTNG_HEATSINK_TEMP, 
-                    sample_adc(MEAS_THEATSINK));
-        scandal_send_scaled_channel(TELEM_LOW, UNSWMPPTNG_15V, 
-                    sample_adc(MEAS_15V));
-        scandal_send_channel(TELEM_LOW, UNSWMPPTNG_STATUS, 
-                    tracker_status); 
-
-        /* Pre-scale for the temperature */ 
-        {
-            int32_t degC = sample_adc(MEAS_TAMBIENT); 
-            degC = (((degC - 1615)*704*1000)/4095);
-            scandal_send_scaled_channel(TELEM_LOW, UNSWMPPTNG_AMBIENT_TEMP, 
-                                        degC);
-        }
-
-#if DEBUG >= 1
-        scandal_send_channel(TELEM_LOW, 134, output);	
-        scandal_send_channel(TELEM_LOW, 136, fpga_nFS()); 
-#endif
+        if(config.telemetry_mode == MPPTNG_TELEMETRY_PACKED)
+            send_packed_telemetry(); 
+        else
+            send_channel_telemetry(); 
     } 
 
     /*  If we're not tracking, 
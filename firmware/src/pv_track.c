@@ -32,6 +32,9 @@
 #include <scandal/utils.h>
 #include <scandal/devices.h>
 #include <scandal/message.h>
+#include <scandal/error.h>
+#include <scandal/can.h>
+#include <scandal/adc.h>
 
 #include <arch/adc.h>
 
@@ -39,14 +42,11 @@
 #include <project/hardware.h>
 #include <project/control.h>
 #include <project/pv_track.h>
-
-/* Different pieces of data to be sent */ 
-#define NO_DATA          0
-#define IVSWEEP_DATA     1
+#include <project/isr_stats.h>
+#include <project/calibration.h>
 
 volatile uint32_t pv_counter; 
 volatile int      pv_algorithm;
-volatile int      senddata_flag; 
 
 sc_time_t         last_debug_data; 
 sc_time_t         last_pvtrack_data; 
@@ -63,12 +63,19 @@ static inline void pvtrack_openloop(void);
 static inline void pvtrack_pando_start(void);
 static inline void pvtrack_pando(void); 
 
+static inline void pvtrack_inccond_start(void);
+static inline void pvtrack_inccond(void); 
+
 static inline void pvtrack_ivsweep_start(void);
 static inline void pvtrack_ivsweep(void);
+static void pvtrack_ivsweep_send_burst(void); 
 
 static inline void pvtrack_manual_start(void);
 static inline void pvtrack_manual(void);
 
+static inline void pvtrack_gmppt_start(void);
+static inline void pvtrack_gmppt(void);
+
 
 /* Algorithm data storage */ 
 volatile union {
@@ -83,30 +90,79 @@ volatile union {
     int direction; 
     uint32_t lastpower; 
     int mode;
+    int variable;     /* Variable step size (MPPTNG_VSPANDO) */ 
+    int32_t lastvin; 
   } pando;
 
   /* Data for the Incremental conductance algorithm */ 
   struct {
-    
+    int mode; 
+    int32_t lastvin;  /* Previous averaged measurements */ 
+    int32_t lastiin; 
+    uint32_t lastpower; 
   } inccond;
 
   /* Data for the IV sweep algorithm */ 
   struct { 
     int last_algorithm; 
-    int32_t vin, iin; 
     int phase; 
+    int32_t target;   /* mV */ 
   } ivsweep; 
 } pvdata; 
+
+/* The last IV sweep. Written by pv_track while capturing, read by the 
+   main loop while sending. Points are 12 bit raw ADC V/I pairs packed 
+   into 3 bytes: V[7:0], I[3:0]V[11:8], I[11:4]. */ 
+static volatile uint8_t ivsweep_buf[IVSWEEP_MAX_POINTS * IVSWEEP_POINT_BYTES]; 
+
+static volatile struct {
+  int state;              /* IVSWEEP_BUF_x */ 
+  uint16_t num_points; 
+  sc_time_t start_time; 
+  uint16_t step_size;     /* mV */ 
+  uint16_t temperature;   /* Raw heatsink temperature */ 
+  uint16_t send_index;    /* Metadata, then points */ 
+} ivsweep_info; 
+
+/* Metadata messages sent ahead of the points */ 
+#define IVSWEEP_NUM_META  4
+
+/* The global tracker runs one of the local algorithms above between 
+   scans, so its state lives outside the union */ 
+volatile struct {
+  int phase; 
+  uint16_t counter;            /* Counts since the last scan / scan point */ 
+  uint16_t sample_counter; 
+  int32_t  best_vin;           /* Raw ADC voltage of the global maximum */ 
+  uint32_t best_power;         /* Raw vin * iin at the global maximum */ 
+  uint16_t num_points;         /* Taken so far in this scan */ 
+} gmppt; 
  
 
 
 /* Interrupt handler associated with internal RTC */
 /* Timer B overflow interrupt */
 interrupt (TIMERB0_VECTOR) timerb0(void) {
+#if ISR_STATS
+  ISR_STATS_ENTER(); 
+  /* Latency from the compare, then schedule the next one */ 
+  uint16_t latency = isr_stats_entry - TBCCR0; 
+  TBCCR0 += ISR_STATS_TICK_HZ / PV_HZ; 
+#endif
+
   pv_track(); 
+
+  ISR_STATS_EXIT(ISR_STATS_TIMERB, latency); 
 }
 
 void pv_track_init(void){
+#if ISR_STATS
+  /* Free-running from SMCLK / 8 -- see isr_stats.h */ 
+  TBCTL = TBCLR | ID_DIV8 | TBSSEL_SMCLK; 
+  TBCCTL0 = CCIE; 
+  TBCCR0 = ISR_STATS_TICK_HZ / PV_HZ; 
+  TBCTL |= MC_CONT; 
+#else
   /* Clear counter, input divider /1, ACLK */
   TBCTL = /*TBIE |*/ TBCLR | ID_DIV1 | TBSSEL_ACLK;
 
@@ -116,6 +172,7 @@ void pv_track_init(void){
   
   /* Start timer in up to CCR0 mode */
   TBCTL |= MC_UPTO_CCR0;
+#endif
 
   /* Initialise variables */ 
   pv_counter = 0; 
@@ -123,21 +180,33 @@ void pv_track_init(void){
   /* Initialise with default algorithm */ 
   pv_track_switchto(config.algorithm); 
 
-  /* Initialise the send data flags */ 
-  senddata_flag = NO_DATA; 
+  /* Nothing to send yet */ 
+  ivsweep_info.state = IVSWEEP_BUF_EMPTY; 
   last_debug_data = sc_get_timer(); 
   last_pvtrack_data = sc_get_timer(); 
 }
 
 
 
+/* Called from the main loop as well as from pv_track(), so the tracker 
+   is held off while the new algorithm's state is set up */ 
 void pv_track_switchto(int algorithm){
+  uint16_t ie = TBCCTL0 & CCIE; 
+
+  PVTRACK_INTERRUPT_DISABLE(); 
+
   switch(algorithm){
   case MPPTNG_PANDO:
     pvtrack_pando_start(); 
     break; 
 
+  case MPPTNG_VSPANDO:
+    pvtrack_pando_start(); 
+    pvdata.pando.variable = 1; 
+    break; 
+
   case MPPTNG_INCCOND:
+    pvtrack_inccond_start(); 
     break; 
 
   case MPPTNG_IVSWEEP:
@@ -147,6 +216,10 @@ void pv_track_switchto(int algorithm){
   case MPPTNG_MANUAL:
     pvtrack_manual_start(); 
     break; 
+
+  case MPPTNG_GMPPT:
+    pvtrack_gmppt_start(); 
+    break; 
     
   case MPPTNG_OPENLOOP:
   default:
@@ -155,6 +228,8 @@ void pv_track_switchto(int algorithm){
   }
 
   pv_algorithm = algorithm; 
+
+  TBCCTL0 |= ie; 
 }
 
 static inline void pv_track(void){
@@ -163,10 +238,12 @@ static inline void pv_track(void){
 
   switch(pv_algorithm){
   case MPPTNG_PANDO:
+  case MPPTNG_VSPANDO:
     pvtrack_pando(); 
     break; 
 
   case MPPTNG_INCCOND:
+    pvtrack_inccond(); 
     break; 
 
   case MPPTNG_IVSWEEP:
@@ -177,6 +254,10 @@ static inline void pv_track(void){
     pvtrack_manual(); 
     break; 
 
+  case MPPTNG_GMPPT:
+    pvtrack_gmppt(); 
+    break; 
+
   case MPPTNG_OPENLOOP:
   default:
     pvtrack_openloop(); 
@@ -192,10 +273,15 @@ void pv_track_send_telemetry(void){
 
 void pv_track_send_data(void){
   sc_time_t thetime = sc_get_timer();
-  if(thetime > last_pvtrack_data + TELEMETRY_UPDATE_PERIOD){
+  if(config.telemetry_mode == MPPTNG_TELEMETRY_CHANNELS && 
+     thetime > last_pvtrack_data + TELEMETRY_UPDATE_PERIOD){
     last_pvtrack_data = thetime; 
-    scandal_send_channel(TELEM_LOW, UNSWMPPTNG_PANDO_POWER, \
-			 pvdata.pando.lastpower);
+    if(pv_algorithm == MPPTNG_INCCOND)
+      scandal_send_channel(TELEM_LOW, UNSWMPPTNG_PANDO_POWER, \
+			   pvdata.inccond.lastpower);
+    else
+      scandal_send_channel(TELEM_LOW, UNSWMPPTNG_PANDO_POWER, \
+			   pvdata.pando.lastpower);
   }
 
   //#define DEBUG
@@ -213,15 +299,111 @@ void pv_track_send_data(void){
   }
 #endif
 
-  if(senddata_flag == IVSWEEP_DATA){
-    scandal_send_channel(TELEM_HIGH, 
-			 UNSWMPPTNG_SWEEP_IN_VOLTAGE, 
-			 pvdata.ivsweep.vin); 
+  if(ivsweep_info.state == IVSWEEP_BUF_SENDING)
+    pvtrack_ivsweep_send_burst(); 
+}
+
+/* Start sending the last complete sweep. 
+   Returns 0 if there is no complete sweep to send. */ 
+int pv_track_ivsweep_send(void){
+  if(ivsweep_info.state != IVSWEEP_BUF_READY && 
+     ivsweep_info.state != IVSWEEP_BUF_SENDING)
+    return 0; 
+
+  {
+    uint16_t ie = TBCCTL0 & CCIE; 
+
+    PVTRACK_INTERRUPT_DISABLE(); 
+    ivsweep_info.send_index = 0; 
+    ivsweep_info.state = IVSWEEP_BUF_SENDING; 
+    TBCCTL0 |= ie; 
+  }
+  return 1; 
+}
+
+static inline void ivsweep_store_point(uint16_t n, uint16_t v, uint16_t i){
+  volatile uint8_t* p = &ivsweep_buf[n * IVSWEEP_POINT_BYTES]; 
+
+  p[0] = v & 0xFF; 
+  p[1] = ((v >> 8) & 0x0F) | ((i & 0x0F) << 4); 
+  p[2] = (i >> 4) & 0xFF; 
+}
 
-    scandal_send_channel(TELEM_HIGH, 
-			 UNSWMPPTNG_SWEEP_IN_CURRENT, 
-			 pvdata.ivsweep.iin); 
-    senddata_flag = 0; 
+/* Frame f of the points, as laid out in pv_track.h */ 
+static inline void ivsweep_point_frame(uint16_t f, can_msg* msg){
+  uint16_t n = f * IVSWEEP_FRAME_POINTS; 
+  volatile uint8_t* p = &ivsweep_buf[n * IVSWEEP_POINT_BYTES]; 
+  uint8_t* d = &msg->data[2]; 
+  uint8_t k, b; 
+
+  msg->length = 2 + IVSWEEP_FRAME_POINTS * IVSWEEP_POINT_BYTES; 
+  msg->data[0] = (n >> 8) & 0xFF; 
+  msg->data[1] = n & 0xFF; 
+
+  for(k = 0; k < IVSWEEP_FRAME_POINTS; k++)
+    for(b = 0; b < IVSWEEP_POINT_BYTES; b++)
+      *d++ = (n + k < ivsweep_info.num_points) ? *p++ : 0; 
+}
+
+/* Send up to IVSWEEP_SEND_BURST messages of the block transfer. A 
+   message the CAN layer can't queue is retried on the next pass, so a 
+   busy bus slows the transfer down rather than dropping points. */ 
+static void pvtrack_ivsweep_send_burst(void){
+  int burst; 
+
+  for(burst = 0; burst < IVSWEEP_SEND_BURST; burst++){
+    uint16_t n = ivsweep_info.send_index; 
+    uint8_t err; 
+
+    if(n >= IVSWEEP_NUM_META + (ivsweep_info.num_points + 
+				 IVSWEEP_FRAME_POINTS - 1) / IVSWEEP_FRAME_POINTS){
+      ivsweep_info.state = IVSWEEP_BUF_READY; 
+      return; 
+    }
+
+    switch(n){
+    case 0:
+      err = scandal_send_channel(TELEM_LOW, UNSWMPPTNG_SWEEP_NUM_POINTS, 
+				 ivsweep_info.num_points); 
+      break; 
+    case 1:
+      err = scandal_send_channel(TELEM_LOW, UNSWMPPTNG_SWEEP_START_TIME, 
+				 ivsweep_info.start_time); 
+      break; 
+    case 2:
+      err = scandal_send_channel(TELEM_LOW, UNSWMPPTNG_SWEEP_STEP_SIZE, 
+				 ivsweep_info.step_size); 
+      break; 
+    case 3:
+      {
+	int32_t temperature = ivsweep_info.temperature; 
+
+	/* Same calibration as the heatsink temperature channel */ 
+	scandal_get_scaled_value(UNSWMPPTNG_HEATSINK_TEMP, &temperature); 
+	err = scandal_send_channel(TELEM_LOW, UNSWMPPTNG_SWEEP_TEMPERATURE, 
+				   temperature); 
+      }
+      break; 
+    default:
+      {
+	can_msg msg; 
+
+	ivsweep_point_frame(n - IVSWEEP_NUM_META, &msg); 
+
+	/* A new sweep has started overwriting the buffer */ 
+	if(ivsweep_info.state != IVSWEEP_BUF_SENDING)
+	  return; 
+
+	msg.id = mpptng_mk_raw_id(TELEM_LOW, UNSWMPPTNG_SWEEP_POINT); 
+	err = can_send_msg(&msg, TELEM_LOW); 
+      }
+      break; 
+    }
+
+    if(err != NO_ERR)
+      return; 
+
+    ivsweep_info.send_index = n + 1; 
   }
 }
 
@@ -235,8 +417,10 @@ static inline void pvtrack_openloop(void){
   switch(pvdata.openloop.mode){
   case OL_SAMPLING:
     if(pv_counter++ >= OL_SAMPLING_COUNT){
-      scandal_get_scaled_value(UNSWMPPTNG_IN_VOLTAGE, &vin_raw);               /* Scale the voltage to the real values */ 
-      control_set_voltage(((int32_t)config.openloop_ratio * vin_raw) / 1000);  /* Set the output voltage */ 
+      int32_t voc = vin_raw; 
+
+      voc = calibration_scale(CAL_VIN, voc);                                   /* Scale the voltage to the real values */ 
+      control_set_voltage(((int32_t)config.openloop_ratio * voc) / 1000);      /* Set the output voltage */ 
 
       pvdata.openloop.mode = OL_CONVERTING;                                    /* Get ready for the next sample */ 
 
@@ -262,20 +446,82 @@ static inline void pvtrack_openloop(void){
 static inline void pvtrack_pando_start(void){
   pvdata.pando.mode = PANDO_SAMPLING;  /* Start out by taking a sample */ 
   pv_counter = 0;                      /* Start counter again */ 
-  pvdata.pando.direction = config.pando_increment;          /* Start positively. :-). */ 
+  pvdata.pando.direction = 1;          /* Start positively. :-). */ 
   pvdata.pando.lastpower = 0;          /* This will get update on our first trip through the loop */ 
+  pvdata.pando.lastvin = 0; 
+  pvdata.pando.variable = 0; 
 
   control_set_voltage(ABS_MAX_VIN);    /* Set the control loop to the absolute maximum input V */ 
 }
 
+/* Variable step size: the step scales with |dP/dV| between the last 
+   two operating points, so it is large on the flanks of the curve 
+   and shrinks to vspando_min_step around the MPP. 
+   This runs in the Timer B ISR, so |dP| / |dV| is a shift and 
+   subtract divide rather than the library's 32 bit one: |dV| is 
+   clamped to the ADC's range, and the quotient to 16 bits, which is 
+   well past where the step saturates at any sensible gain. The 
+   divisor is shifted up once and then down a bit at a time, as the 
+   MSP430 only shifts by one. */ 
+#define VSPANDO_QUOTIENT_BITS    16
+
+static inline uint32_t pvtrack_vspando_quotient(uint32_t dp, uint32_t dv){
+  uint32_t q = 0; 
+  uint8_t n; 
+
+  dv <<= VSPANDO_QUOTIENT_BITS; 
+  if(dp >= dv)
+    return (1UL << VSPANDO_QUOTIENT_BITS) - 1; 
+
+  for(n = VSPANDO_QUOTIENT_BITS; n != 0; n--){
+    dv >>= 1; 
+    q <<= 1; 
+    if(dp >= dv){
+      dp -= dv; 
+      q |= 1; 
+    }
+  }
+
+  return q; 
+}
+
+static inline int32_t pvtrack_vspando_step(uint32_t power_raw){
+  int32_t dp, dv, step; 
+
+  dp = (int32_t)(power_raw - pvdata.pando.lastpower); 
+  dv = vin_raw - pvdata.pando.lastvin; 
+  if(dp < 0)
+    dp = -dp; 
+  if(dv < 0)
+    dv = -dv; 
+  if(dv > CAL_ADC_FULL_SCALE)
+    dv = CAL_ADC_FULL_SCALE; 
+
+  if(dv == 0 || pvdata.pando.lastpower == 0)
+    step = config.vspando_max_step; 
+  else
+    step = (pvtrack_vspando_quotient(dp, dv) * config.vspando_gain) 
+      >> VSPANDO_GAIN_SHIFT; 
+
+  if(step > config.vspando_max_step)
+    step = config.vspando_max_step; 
+  else if(step < config.vspando_min_step)
+    step = config.vspando_min_step; 
+
+  return step; 
+}
+
 static inline void pvtrack_pando(void){
   uint64_t power_raw;
+  int32_t step; 
 
   switch(pvdata.pando.mode){
   case PANDO_SAMPLING:
     if((pv_counter++) >= PANDO_SAMPLE_COUNT){
-      scandal_get_scaled_value(UNSWMPPTNG_IN_VOLTAGE, &vin_raw);               /* Scale the voltage to the real values */ 
-      control_set_voltage(((int32_t)config.openloop_ratio * vin_raw) / 1000);  /* Set the output voltage */ 
+      int32_t voc = vin_raw; 
+
+      voc = calibration_scale(CAL_VIN, voc);                                   /* Scale the voltage to the real values */ 
+      control_set_voltage(((int32_t)config.openloop_ratio * voc) / 1000);      /* Set the output voltage */ 
 
       pvdata.pando.mode = PANDO_TRACKING;                                    /* Get ready for the next sample */ 
 
@@ -284,17 +530,23 @@ static inline void pvtrack_pando(void){
     break; 
 
   case PANDO_TRACKING:
-    if((pv_counter++) >= PANDO_UPDATE_COUNT){
+    if((pv_counter++) >= config.pando_update_period){
       power_raw = (uint64_t)vin_raw * (uint64_t)iin_raw; 
+
+      if(pvdata.pando.variable)
+	step = pvtrack_vspando_step(power_raw); 
+      else
+	step = config.pando_increment; 
       
       /* If we got less power than last time, switch directions */ 
       if(power_raw < pvdata.pando.lastpower)
 	pvdata.pando.direction = -pvdata.pando.direction; 
       
       /* Take an offset from the present value */ 
-      control_set_raw(vin_raw + pvdata.pando.direction);
+      control_set_raw(vin_raw + pvdata.pando.direction * step);
       
       pvdata.pando.lastpower = power_raw; 
+      pvdata.pando.lastvin = vin_raw; 
       
       toggle_red_led(); 
       pv_counter = 0;
@@ -303,8 +555,73 @@ static inline void pvtrack_pando(void){
   }
 }
 
+/* Incremental conductance. 
+   At the MPP dP/dV = I + V dI/dV = 0. Multiplying through by V dV 
+   (V is always positive) gives the divide-free test 
+       s = V dI + I dV,   sign(dP/dV) = sign(s) * sign(dV) 
+   which is evaluated on the raw averaged ADC values. Inside the 
+   tolerance band the target is left alone, so there is no 
+   steady-state dither. */ 
+static inline void pvtrack_inccond_start(void){
+  pvdata.inccond.mode = INCCOND_SAMPLING;  /* Start out by taking a sample */ 
+  pv_counter = 0;                          /* Start counter again */ 
+  pvdata.inccond.lastvin = 0; 
+  pvdata.inccond.lastiin = 0; 
+  pvdata.inccond.lastpower = 0; 
+
+  control_set_voltage(ABS_MAX_VIN);    /* Set the control loop to the absolute maximum input V */ 
+}
+
 static inline void pvtrack_inccond(void){
-  
+  int32_t dv, di, s, tolerance; 
+  int step = 0; 
+
+  switch(pvdata.inccond.mode){
+  case INCCOND_SAMPLING:
+    if((pv_counter++) >= PANDO_SAMPLE_COUNT){
+      int32_t voc = vin_raw; 
+
+      voc = calibration_scale(CAL_VIN, voc);                                /* Scale the voltage to the real values */ 
+      control_set_voltage(((int32_t)config.openloop_ratio * voc) / 1000);   /* Start from the open loop estimate */ 
+
+      pvdata.inccond.mode = INCCOND_TRACKING; 
+      pv_counter = 0; 
+    }
+    break; 
+
+  case INCCOND_TRACKING:
+    if((pv_counter++) >= INCCOND_UPDATE_COUNT){
+      dv = vin_raw - pvdata.inccond.lastvin; 
+      di = iin_raw - pvdata.inccond.lastiin; 
+
+      if(dv >= INCCOND_MIN_DV || dv <= -INCCOND_MIN_DV){
+	s = vin_raw * di + iin_raw * dv; 
+	tolerance = ((dv < 0 ? -dv : dv) * iin_raw) >> INCCOND_TOLERANCE_SHIFT; 
+
+	if(s > tolerance)
+	  step = (dv > 0) ? 1 : -1;       /* dP/dV > 0: left of the MPP */ 
+	else if(s < -tolerance)
+	  step = (dv > 0) ? -1 : 1;       /* dP/dV < 0: right of the MPP */ 
+      }else{
+	/* Voltage unchanged -- follow the current (irradiance) change */ 
+	if(di >= INCCOND_MIN_DI)
+	  step = 1; 
+	else if(di <= -INCCOND_MIN_DI)
+	  step = -1; 
+      }
+
+      if(step != 0){
+	control_set_raw(control_get_target() + step * (int32_t)config.pando_increment); 
+	toggle_red_led(); 
+      }
+
+      pvdata.inccond.lastvin = vin_raw; 
+      pvdata.inccond.lastiin = iin_raw; 
+      pvdata.inccond.lastpower = vin_raw * iin_raw; 
+      pv_counter = 0; 
+    }
+    break; 
+  }
 }
 
 static inline void pvtrack_ivsweep_start(void){
@@ -317,6 +634,10 @@ static inline void pvtrack_ivsweep_start(void){
     pvdata.ivsweep.last_algorithm = pv_algorithm; 
     control_set_voltage(ABS_MAX_VIN);
     pv_counter = 0; 
+
+    /* Any sweep in the buffer (or being sent) is about to be replaced */ 
+    ivsweep_info.state = IVSWEEP_BUF_CAPTURING; 
+    ivsweep_info.num_points = 0; 
   }
 }
 
@@ -326,28 +647,37 @@ static inline void pvtrack_ivsweep(void){
     if(pv_counter > PVTRACK_PERIOD_TO_COUNT(IVSWEEP_SETTLE_MS)){
       pvdata.ivsweep.phase = IVSWEEP_PHASE_SWEEP; 
       pv_counter = 0; 
+
+      /* Start from the open circuit voltage */ 
+      {
+	int32_t voc = vin_raw; 
+	voc = calibration_scale(CAL_VIN, voc); 
+	pvdata.ivsweep.target = voc; 
+      }
+
+      ivsweep_info.start_time = sc_get_timer(); 
+      ivsweep_info.step_size = config.ivsweep_step_size; 
+      ivsweep_info.temperature = sample_adc(MEAS_THEATSINK); 
     }else
       pv_counter++;
     break; 
     
   case IVSWEEP_PHASE_SWEEP:
     if((pv_counter++) >= config.ivsweep_sample_period){
-      uint32_t vin = vin_raw, iin=iin_raw; 
+      ivsweep_store_point(ivsweep_info.num_points++, vin_raw, iin_raw); 
 
-      scandal_get_scaled_value(UNSWMPPTNG_IN_VOLTAGE, &vin); 
-      scandal_get_scaled_value(UNSWMPPTNG_IN_CURRENT, &iin); 
-      
-      pvdata.ivsweep.vin = vin; 
-      pvdata.ivsweep.iin = iin; 
-      senddata_flag = IVSWEEP_DATA; 
-      
-      vin -= config.ivsweep_step_size; 
-      /* Once we hit the lowest voltage, switch
+      /* Step the target rather than the measurement, so the sweep 
+	 moves at a fixed rate even while the input loop is catching up */ 
+      pvdata.ivsweep.target -= config.ivsweep_step_size; 
+
+      /* Once we hit the lowest voltage or fill the buffer, switch
 	 back to the original algorithm */ 
-      if((vin < config.min_vin) || (control_is_saturated()))
+      if((pvdata.ivsweep.target < config.min_vin) || (control_is_saturated()) || 
+	 (ivsweep_info.num_points >= config.ivsweep_num_points)){
+	ivsweep_info.state = IVSWEEP_BUF_READY; 
 	pv_track_switchto(pvdata.ivsweep.last_algorithm); 
-      
-      control_set_voltage(vin); 
+      }else
+	control_set_voltage(pvdata.ivsweep.target); 
       
       pv_counter = 0; 
     }
@@ -355,6 +685,95 @@ static inline void pvtrack_ivsweep(void){
   }
 }
 
+/* Global MPPT for partially shaded strings. 
+   Every gmppt_scan_period the string is taken to open circuit and 
+   swept down to min_vin in gmppt_step_size steps, as in the IV sweep 
+   but without sending each point, and for at most GMPPT_MAX_POINTS. 
+   The target then jumps to the point with the most power and the local 
+   algorithm takes over. */ 
+static inline void pvtrack_gmppt_scan_start(void){
+  gmppt.phase = GMPPT_PHASE_SETTLE; 
+  gmppt.counter = 0; 
+  gmppt.sample_counter = 0; 
+  gmppt.best_vin = 0; 
+  gmppt.best_power = 0; 
+  gmppt.num_points = 0; 
+  control_set_voltage(ABS_MAX_VIN); 
+}
+
+static inline void pvtrack_gmppt_start(void){
+  pvtrack_gmppt_scan_start(); 
+}
+
+/* Hand over to the local tracker, skipping its own open loop 
+   sampling phase since we already know where the peak is */ 
+static inline void pvtrack_gmppt_handover(void){
+  control_set_raw(gmppt.best_vin); 
+  pv_counter = 0; 
+
+  if(config.gmppt_local_algorithm == MPPTNG_PANDO || 
+     config.gmppt_local_algorithm == MPPTNG_VSPANDO){
+    pvdata.pando.mode = PANDO_TRACKING; 
+    pvdata.pando.direction = 1; 
+    pvdata.pando.lastpower = 0; 
+    pvdata.pando.lastvin = gmppt.best_vin; 
+    pvdata.pando.variable = (config.gmppt_local_algorithm == MPPTNG_VSPANDO); 
+  }else{
+    pvdata.inccond.mode = INCCOND_TRACKING; 
+    pvdata.inccond.lastvin = gmppt.best_vin; 
+    pvdata.inccond.lastiin = 0; 
+    pvdata.inccond.lastpower = 0; 
+  }
+
+  gmppt.phase = GMPPT_PHASE_TRACK; 
+  gmppt.counter = 0; 
+}
+
+static inline void pvtrack_gmppt(void){
+  switch(gmppt.phase){
+  case GMPPT_PHASE_SETTLE:
+    if((gmppt.counter++) >= GMPPT_SETTLE_COUNT){
+      gmppt.phase = GMPPT_PHASE_SCAN; 
+      gmppt.sample_counter = config.gmppt_sample_period; 
+    }
+    break; 
+
+  case GMPPT_PHASE_SCAN:
+    if((gmppt.sample_counter++) >= config.gmppt_sample_period){
+      uint32_t power = (uint32_t)vin_raw * (uint32_t)iin_raw; 
+      int32_t vin = vin_raw; 
+
+      if(power > gmppt.best_power){
+	gmppt.best_power = power; 
+	gmppt.best_vin = vin_raw; 
+      }
+
+      vin = calibration_scale(CAL_VIN, vin); 
+      vin -= config.gmppt_step_size; 
+
+      if((vin < config.min_vin) || (control_is_saturated()) || 
+	 (++gmppt.num_points >= GMPPT_MAX_POINTS))
+	pvtrack_gmppt_handover(); 
+      else
+	control_set_voltage(vin); 
+
+      gmppt.sample_counter = 0; 
+    }
+    break; 
+
+  case GMPPT_PHASE_TRACK:
+  default:
+    if(config.gmppt_local_algorithm == MPPTNG_INCCOND)
+      pvtrack_inccond(); 
+    else
+      pvtrack_pando(); 
+
+    if((gmppt.counter++) >= config.gmppt_scan_period)
+      pvtrack_gmppt_scan_start(); 
+    break; 
+  }
+}
+
 static inline void pvtrack_manual_start(void){
     control_set_voltage(ABS_MAX_VIN);
 }
@@ -47,6 +47,9 @@
 #include <project/pv_track.h>
 #include <project/config.h>
 #include <project/mpptng_error.h>
+#include <project/scope.h>
+#include <project/isr_stats.h>
+#include <project/autotune.h>
 
 /* Reset the node in a safe manner
 	- will be called from handle_scandal */
@@ -77,102 +80,253 @@ void scandal_user_do_first_run(void){
   scandal_set_m(UNSWMPPTNG_AMBIENT_TEMP, DEFAULT_AMBIENT_TEMP_M);
   scandal_set_b(UNSWMPPTNG_AMBIENT_TEMP, DEFAULT_AMBIENT_TEMP_B); 
 
-  config.max_vout = DEFAULT_MAX_VOUT; 
-  config.min_vin = DEFAULT_MIN_VIN;
-  config.algorithm = DEFAULT_ALGORITHM; 
-  config.in_pid_const.Kp = DEFAULT_IN_KP; 
-  config.in_pid_const.Ki = DEFAULT_IN_KI; 
-  config.in_pid_const.Kd = DEFAULT_IN_KD; 
-  config.out_pid_const.Kp = DEFAULT_OUT_KP; 
-  config.out_pid_const.Ki = DEFAULT_OUT_KI; 
-  config.out_pid_const.Kd = DEFAULT_OUT_KD;
- 
-  config.openloop_ratio = DEFAULT_OPENLOOP_RATIO; 
-  config.openloop_retrack_period = 
-    PVTRACK_PERIOD_TO_COUNT(DEFAULT_OPENLOOP_RETRACK_PERIOD); 
-  config.pando_increment = DEFAULT_PANDO_INCREMENT; 
-  config.ivsweep_step_size = DEFAULT_IVSWEEP_STEP_SIZE; 
-  config.ivsweep_sample_period = 
-    PVTRACK_PERIOD_TO_COUNT(DEFAULT_IVSWEEP_SAMPLE_PERIOD); 
-
+  config_defaults(); 
   config_write(); 
 
   return;
 }
 
+/* Every parameter takes effect straight away, without stopping the 
+   tracker: the 16 bit ones are written in one go, and anything wider, or 
+   copied by the control loop, is changed with the interrupt that uses it 
+   held off. The EEPROM is written once the changes stop -- see 
+   config_flush(). */ 
 u08 scandal_user_do_config(u08 param, s32 value, s32 value2){
-  /* Disable the tracker */ 
-  fpga_enable(FPGA_OFF); 
-  tracker_status &= ~STATUS_TRACKING; 
+  u08 changed = 0; 
 
   switch(param){
   case UNSWMPPTNG_MAX_VOUT:
-    if(value <= ABS_MAX_VOUT)
+    if(value <= ABS_MAX_VOUT){
+      PVTRACK_INTERRUPT_DISABLE(); 
       config.max_vout = value;
+      changed = 1; 
+      PVTRACK_INTERRUPT_ENABLE(); 
+    }
     update_control_maxmin();
     break; 
     
   case UNSWMPPTNG_MIN_VIN:
-    if(value >= ABS_MIN_VIN)
+    if(value >= ABS_MIN_VIN){
+      PVTRACK_INTERRUPT_DISABLE(); 
       config.min_vin = value;
+      changed = 1; 
+      PVTRACK_INTERRUPT_ENABLE(); 
+    }
     update_control_maxmin();
     break; 
     
   case UNSWMPPTNG_ALGORITHM:
-    config.algorithm = value;
-    pv_track_switchto(config.algorithm); 
+    if(value >= 0 && value < MPPTNG_NUM_ALGORITHMS){
+      config.algorithm = value;
+      changed = 1; 
+      pv_track_switchto(config.algorithm); 
+    }
     break; 
 
   case UNSWMPPTNG_IN_KP:
     config.in_pid_const.Kp = value; 
+    changed = 1; 
+    control_update_gains(); 
     break; 
     
   case UNSWMPPTNG_IN_KI:
     config.in_pid_const.Ki = value; 
+    changed = 1; 
+    control_update_gains(); 
     break; 
     
   case UNSWMPPTNG_IN_KD:
     config.in_pid_const.Kd = value; 
+    changed = 1; 
+    control_update_gains(); 
     break; 
 
   case UNSWMPPTNG_OUT_KP:
     config.out_pid_const.Kp = value; 
+    changed = 1; 
+    control_update_gains(); 
     break; 
     
   case UNSWMPPTNG_OUT_KI:
     config.out_pid_const.Ki = value; 
+    changed = 1; 
+    control_update_gains(); 
     break; 
     
   case UNSWMPPTNG_OUT_KD:
     config.out_pid_const.Kd = value; 
+    changed = 1; 
+    control_update_gains(); 
     break; 
 
   case UNSWMPPTNG_OPENLOOP_RATIO:
     config.openloop_ratio = value; 
+    changed = 1; 
     break; 
 
   case UNSWMPPTNG_OPENLOOP_RETRACK_PERIOD:
     config.openloop_retrack_period = 
       PVTRACK_PERIOD_TO_COUNT(value);
+    changed = 1; 
     break; 
 
   case UNSWMPPTNG_PANDO_INCREMENT:
-    config.pando_increment = value; 
+    if(value > 0 && value <= 0xFFFF){
+      config.pando_increment = value; 
+      changed = 1; 
+    }
+    break; 
+
+  case UNSWMPPTNG_PANDO_UPDATE_PERIOD:
+    if(value >= 0 && value <= PVTRACK_MAX_PERIOD){
+      config.pando_update_period = 
+	PVTRACK_PERIOD_TO_COUNT(value); 
+      changed = 1; 
+    }
+    break; 
+
+  case UNSWMPPTNG_VSPANDO_MIN_STEP:
+    if(value > 0 && value <= config.vspando_max_step){
+      config.vspando_min_step = value; 
+      changed = 1; 
+    }
+    break; 
+
+  case UNSWMPPTNG_VSPANDO_MAX_STEP:
+    if(value >= config.vspando_min_step && value <= 0xFFFF){
+      config.vspando_max_step = value; 
+      changed = 1; 
+    }
+    break; 
+
+  case UNSWMPPTNG_VSPANDO_GAIN:
+    if(value > 0 && value <= 0xFFFF){
+      config.vspando_gain = value; 
+      changed = 1; 
+    }
     break; 
 
   case UNSWMPPTNG_IVSWEEP_SAMPLE_PERIOD:
-    config.ivsweep_sample_period = 
-      PVTRACK_PERIOD_TO_COUNT(value); 
+    if(value >= 0 && value <= PVTRACK_MAX_PERIOD){
+      config.ivsweep_sample_period = 
+	PVTRACK_PERIOD_TO_COUNT(value); 
+      changed = 1; 
+    }
     break; 
 
   case UNSWMPPTNG_IVSWEEP_STEP_SIZE: 
-    config.ivsweep_step_size = value; 
+    if(value > 0 && value <= 0xFFFF){
+      config.ivsweep_step_size = value; 
+      changed = 1; 
+    }
+    break; 
+
+  case UNSWMPPTNG_IVSWEEP_NUM_POINTS: 
+    if(value < 1)
+      value = 1; 
+    if(value > IVSWEEP_MAX_POINTS)
+      value = IVSWEEP_MAX_POINTS; 
+    config.ivsweep_num_points = value; 
+    changed = 1; 
+    break; 
+
+  case UNSWMPPTNG_TELEMETRY_MODE: 
+    if(value == MPPTNG_TELEMETRY_CHANNELS || value == MPPTNG_TELEMETRY_PACKED){
+      config.telemetry_mode = value; 
+      changed = 1; 
+    }
+    break; 
+
+  case UNSWMPPTNG_GMPPT_SCAN_PERIOD:
+    /* A count of 0 would start a new scan as soon as one ends */ 
+    if(value >= PVTRACK_MIN_PERIOD && value <= PVTRACK_MAX_PERIOD){
+      config.gmppt_scan_period = 
+	PVTRACK_PERIOD_TO_COUNT(value); 
+      changed = 1; 
+    }
+    break; 
+
+  case UNSWMPPTNG_GMPPT_SAMPLE_PERIOD:
+    /* 0 is a point every pv_track tick */ 
+    if(value >= 0 && value <= PVTRACK_MAX_PERIOD){
+      config.gmppt_sample_period = 
+	PVTRACK_PERIOD_TO_COUNT(value); 
+      changed = 1; 
+    }
+    break; 
+
+  case UNSWMPPTNG_GMPPT_STEP_SIZE:
+    if(value <= 0 || value > 0xFFFF)
+      break; 
+    if(value < GMPPT_MIN_STEP_SIZE)
+      value = GMPPT_MIN_STEP_SIZE; 
+    config.gmppt_step_size = value; 
+    changed = 1; 
+    break; 
+
+  case UNSWMPPTNG_GMPPT_LOCAL_ALGORITHM:
+    if(value == MPPTNG_PANDO || value == MPPTNG_INCCOND || 
+       value == MPPTNG_VSPANDO){
+      config.gmppt_local_algorithm = value; 
+      changed = 1; 
+    }
+    break; 
+
+  case UNSWMPPTNG_NUM_PHASES:
+    if(value >= 1 && value <= FPGA_MAX_PHASES){
+      config.num_phases = value; 
+      changed = 1; 
+    }
+    break; 
+
+  case UNSWMPPTNG_PHASE_CURRENT:
+    if(value > 0 && value <= 0xFFFF){
+      config.phase_current = value; 
+      changed = 1; 
+    }
+    break; 
+
+  case UNSWMPPTNG_FEEDFORWARD:
+    config.feedforward = (value != 0); 
+    changed = 1; 
+    break; 
+
+  case UNSWMPPTNG_FEEDFORWARD_GAIN:
+    if(value >= 0 && value <= 0xFF){
+      config.feedforward_gain = value; 
+      changed = 1; 
+    }
+    break; 
+
+  case UNSWMPPTNG_GAIN_BAND_CURRENT:
+    if(value > 0 && value <= 0xFFFF){
+      config.gain_band_current = value; 
+      changed = 1; 
+      control_update_gains(); 
+    }
+    break; 
+
+  default:
+    /* One parameter per band for the gain schedules */ 
+    if(value <= 0 || value > 0xFF)
+      break; 
+    if(param >= UNSWMPPTNG_IN_GAIN_SCHEDULE && 
+       param < UNSWMPPTNG_IN_GAIN_SCHEDULE + GAIN_SCHEDULE_BANDS){
+      config.in_gain_schedule[param - UNSWMPPTNG_IN_GAIN_SCHEDULE] = value; 
+      changed = 1; 
+    }else if(param >= UNSWMPPTNG_OUT_GAIN_SCHEDULE && 
+             param < UNSWMPPTNG_OUT_GAIN_SCHEDULE + GAIN_SCHEDULE_BANDS){
+      config.out_gain_schedule[param - UNSWMPPTNG_OUT_GAIN_SCHEDULE] = value; 
+      changed = 1; 
+    }
+    if(changed)
+      control_update_gains(); 
+    break; 
   }
   
-  config_write(); 
-  
-  /* Reset the tracker to get us started again */ 
-  scandal_reset_node(); 
+  /* Only a value that was taken needs writing to the EEPROM */ 
+  if(changed)
+    config_changed(); 
 
   return NO_ERR;
 }
@@ -182,6 +336,18 @@ u08 scandal_user_handle_command(u08 command, u08* data){
   case UNSWMPPTNG_COMMAND_IVSWEEP:
     pv_track_switchto(MPPTNG_IVSWEEP);
     break;
+  case UNSWMPPTNG_COMMAND_IVSWEEP_SEND:
+    pv_track_ivsweep_send(); 
+    break;
+  case UNSWMPPTNG_COMMAND_SCOPE_ARM:
+    scope_arm(data); 
+    break;
+  case UNSWMPPTNG_COMMAND_SCOPE_SEND:
+    scope_send(); 
+    break;
+  case UNSWMPPTNG_COMMAND_ISR_STATS:
+    isr_stats_send(); 
+    break;
   case UNSWMPPTNG_COMMAND_SET_TARGET:
     {
       uint32_t value; 
@@ -194,23 +360,7 @@ u08 scandal_user_handle_command(u08 command, u08* data){
     break;
 
   case UNSWMPPTNG_COMMAND_SET_AND_TUNE:
-    {
-      uint32_t value; 
-      sc_time_t waittime; 
-
-      value = ((uint32_t)data[0]) << 24 |
-	((uint32_t)data[1]) << 16 |
-	((uint32_t)data[2]) << 8 |
-	((uint32_t)data[3]) << 0 ;
-      control_set_voltage(value);
-
-      waittime = sc_get_timer();
-
-      while(sc_get_timer() < waittime + 300){
-	scandal_send_channel(TELEM_LOW, 161, sample_adc(MEAS_VIN1));
-	scandal_send_channel(TELEM_LOW, 162, output);
-      }
-    }
+    autotune_start(data); 
     break;
     
 
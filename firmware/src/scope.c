@@ -0,0 +1,135 @@
+/* Copyright (C) agent, 2026 */ 
+
+/* 
+ * This file is part of the UNSWMPPTNG firmware.
+ * 
+ * The UNSWMPPTNG firmware is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ 
+ * The UNSWMPPTNG firmware is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ 
+ * You should have received a copy of the GNU General Public License
+ * along with the UNSWMPPTNG firmware.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Control loop scope -- arming and read out. 
+   The capture itself is scope_record() in scope.h, run from the ADC ISR. */ 
+
+#include <io.h>
+#include <signal.h>
+
+#include <scandal/engine.h>
+#include <scandal/message.h>
+#include <scandal/error.h>
+#include <scandal/can.h>
+#include <scandal/devices.h>
+
+#include <arch/adc.h>
+
+#include <project/mpptng.h>
+#include <project/scope.h>
+
+volatile scope_state_t  scope; 
+volatile scope_sample_t scope_buf[SCOPE_DEPTH]; 
+
+void scope_arm(u08* data){
+  ADC_INTERRUPT_DISABLE(); 
+
+  scope.mask = data[0]; 
+  scope.pre = data[1]; 
+  if(scope.pre > SCOPE_DEPTH - 1)
+    scope.pre = SCOPE_DEPTH - 1; 
+  scope.decimation = data[2] ? data[2] : 1; 
+  scope.decimate_count = 1; 
+  scope.level_channel = data[3]; 
+  scope.level = ((uint16_t)data[4] << 8) | data[5]; 
+
+  /* The first sample can't be a crossing */ 
+  scope.last_level = (scope.level_channel & SCOPE_LEVEL_RISING) ? 0xFFFF : 0; 
+
+  scope.index = 0; 
+  scope.filled = 0; 
+  scope.cause = SCOPE_TRIG_NOW; 
+  scope.state = SCOPE_ARMED; 
+
+  /* No trigger conditions -- just fill the buffer */ 
+  if(scope.mask == SCOPE_TRIG_NOW){
+    scope.pre = 0; 
+    scope.state = SCOPE_TRIGGERED; 
+    scope.remaining = SCOPE_DEPTH; 
+  }
+
+  ADC_INTERRUPT_ENABLE(); 
+}
+
+/* Start sending a completed capture. 
+   Returns 0 if there isn't one. */ 
+int scope_send(void){
+  if(scope.state != SCOPE_DONE && scope.state != SCOPE_SENDING)
+    return 0; 
+
+  scope.send_index = 0; 
+  scope.state = SCOPE_SENDING; 
+  return 1; 
+}
+
+static inline void put16(u08* data, uint16_t value){
+  data[0] = (value >> 8) & 0xFF; 
+  data[1] = value & 0xFF; 
+}
+
+/* Called from the main loop. Sends up to SCOPE_SEND_BURST messages of 
+   the capture, retrying whatever the CAN layer couldn't queue on the 
+   next pass. */ 
+void scope_send_data(void){
+  int burst; 
+
+  if(scope.state != SCOPE_SENDING)
+    return; 
+
+  for(burst = 0; burst < SCOPE_SEND_BURST; burst++){
+    uint8_t n = scope.send_index; 
+    uint8_t err; 
+
+    if(n > SCOPE_DEPTH){
+      scope.state = SCOPE_DONE; 
+      return; 
+    }
+
+    if(n == 0){
+      err = scandal_send_channel(TELEM_LOW, UNSWMPPTNG_SCOPE_INFO, 
+				 ((uint32_t)scope.cause << 16) | 
+				 ((uint32_t)scope.pre << 8) | 
+				 scope.decimation); 
+    }else{
+      volatile scope_sample_t* p; 
+      uint8_t i = n - 1; 
+      uint8_t k = scope.index + i; 
+      can_msg msg; 
+
+      /* Oldest first -- scope.index is the oldest sample once done */ 
+      if(k >= SCOPE_DEPTH)
+	k -= SCOPE_DEPTH; 
+      p = &scope_buf[k]; 
+
+      msg.id = scandal_mk_channel_id(TELEM_LOW, scandal_get_addr(), 
+				     UNSWMPPTNG_SCOPE_DATA); 
+      msg.length = 8; 
+      put16(&msg.data[0], p->vin); 
+      put16(&msg.data[2], (p->vout & 0x0FFF) | ((uint16_t)(i & 0xF0) << 8)); 
+      put16(&msg.data[4], (p->iin & 0x0FFF) | ((uint16_t)(i & 0x0F) << 12)); 
+      put16(&msg.data[6], p->output); 
+      err = can_send_msg(&msg, TELEM_LOW); 
+    }
+
+    if(err != NO_ERR)
+      return; 
+
+    scope.send_index = n + 1; 
+  }
+}